@@ -0,0 +1,74 @@
+#!/bin/bash
+
+# Compares the extension search of full consistency checks against the
+# enumeration of all co/lb extensions (-enumerate-extensions). For each
+# testcase, it reports the running time of both engines, and flags any
+# difference in the number of executions explored.
+#
+# Usage: ./bench-full-cons.sh [testdir] [time-limit]
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, you can access it online at
+# http://www.gnu.org/licenses/gpl-2.0.html.
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+GenMC="${GenMC:-$DIR/../src/genmc}"
+
+source "${DIR}/terminal.sh"
+
+model="${model:-rc11}"
+testdir="${1:-${DIR}/../tests/correct/litmus}"
+limit="${2:-60}"
+
+shopt -s nullglob
+
+# Runs GenMC with full checks and extra flags $1 on ${t};
+# prints "<time> <executions>", with time "TO" on a timeout
+run_full() {
+    output=`timeout "${limit}" "${GenMC}" ${GENMCFLAGS} "-${model}" -wb \
+	    -check-consistency-type=full -check-consistency-point=exec $1 \
+	    -- ${CFLAGS} "${t}" 2>&1`
+    [[ $? -eq 124 ]] && echo "TO -" && return
+    time=`echo "${output}" | awk '/time/ { print substr($4, 1, length($4)-1) }'`
+    execs=`echo "${output}" | awk '/complete executions/ { print $6 }'`
+    echo "${time:-0} ${execs:--}"
+}
+
+printline
+printf "| ${CYAN}%-32s${NC} | ${CYAN}%-9s${NC} | ${CYAN}%-9s${NC} | ${CYAN}%-7s${NC} |\n" \
+       "Testcase" "Enumerate" "Search" "Speedup"
+printline
+
+for dir in "${testdir}"/*
+do
+    for t in $dir/variants/*.c
+    do
+	read enum_time enum_execs <<< `run_full "-enumerate-extensions"`
+	read search_time search_execs <<< `run_full ""`
+	speedup="-"
+	if [[ "${search_time}" != "TO" ]] && (( $(echo "${search_time} > 0" | bc -l) ))
+	then
+	    [[ "${enum_time}" == "TO" ]] && speedup=">"`echo "scale=2; ${limit}/${search_time}" | bc -l`
+	    [[ "${enum_time}" != "TO" ]] && speedup=`echo "scale=2; ${enum_time}/${search_time}" | bc -l`
+	fi
+	name="${dir##*/}/${t##*/}"
+	if [[ "${enum_execs}" != "-" && "${search_execs}" != "-" && \
+	      "${enum_execs}" != "${search_execs}" ]]
+	then
+	    name="${RED}${name}${NC} (${enum_execs} vs ${search_execs} executions)"
+	fi
+	printf "| ${POWDER_BLUE}%-32s${NC} | % 9s | % 9s | % 7s |\n" \
+	       "${name}" "${enum_time}" "${search_time}" "${speedup}"
+    done
+done
+printline
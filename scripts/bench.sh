@@ -0,0 +1,235 @@
+#!/bin/bash
+
+# Runs a curated set of testcases under tests/correct for every
+# combination of -nthreads and coherence type, and records the number
+# of executions per second, the peak RSS, the per-phase timings and
+# the number of interpreted instructions (along with their rate in the
+# interpreter proper) reported by -print-stats-json. The results are
+# compared against a baseline (as produced by a previous run with
+# format=csv; bench-baseline.csv by default, baseline= to disable) and
+# the script fails if the throughput of some configuration dropped by
+# more than the given tolerance. Configurations missing from the
+# baseline, or faster than mintime seconds in it, are not compared.
+#
+# Usage: [nthreads="1 4"] [coherences="mo wb"] [runs=N] [format=csv|json]
+#        [output=file] [baseline=file] [tolerance=percent] [mintime=secs]
+#        ./bench.sh [tests...]
+#
+# Tests are given relative to tests/correct (e.g., data-structures/ms-queue).
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, you can access it online at
+# http://www.gnu.org/licenses/gpl-2.0.html.
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+GenMC="${GenMC:-$DIR/../src/genmc}"
+
+source "${DIR}/terminal.sh"
+
+testdir="${DIR}/../tests/correct"
+nthreads="${nthreads:-1 4}"
+coherences="${coherences:-mo wb}"
+runs="${runs:-1}"
+format="${format:-csv}"
+output="${output:-${DIR}/../bench.${format}}"
+baseline="${baseline-${DIR}/bench-baseline.csv}"
+tolerance="${tolerance:-10}"
+mintime="${mintime:-0.1}"
+limit="${limit:-300}"
+
+tests=("$@")
+if [[ ${#tests[@]} -eq 0 ]]
+then
+    tests=(
+	data-structures/ms-queue
+	data-structures/treiber-stack
+	data-structures/mpmc-queue
+	data-structures/spinlock
+	data-structures/qspinlock
+	litmus/IRIW-acq-sc
+	litmus/LB
+	synthetic/N-writers
+	lkmm/IRIW+poonceonces+OnceOnce
+	channels/spsc
+	channels/mpsc
+	channels/handoff
+    )
+fi
+
+# Inputs larger than the test suite's, so that the runs take long
+# enough (see mintime) for their rates to be compared
+declare -A bench_args=(
+    [synthetic/N-writers]="-DN=7"
+    [channels/spsc]="-DN=9"
+    [channels/mpsc]="-DN=5"
+    [channels/handoff]="-DN=4"
+)
+
+phases=(updateLabelViews getRfsApproximation calcRevisits copyGraph
+	isConsistent restrictGraph replay)
+
+shopt -s nullglob
+
+statsfile=`mktemp`
+trap 'rm -f "${statsfile}"' EXIT
+
+# Picks the model each category is meant to be checked under
+model_for() {
+    case "$1" in
+	lkmm/*)     echo "lkmm" ;;
+	channels/*) echo "mpsc" ;;
+	*)          echo "rc11" ;;
+    esac
+}
+
+# Runs ${t} and prints "<time> <executions> <rss> <instructions> <interpreter-ms> <phase-ms>...",
+# keeping the fastest of all runs; the time is "TO" on a timeout
+run_test() {
+    best=""
+    for ((r=0;r<runs;r++))
+    do
+	out=`timeout "${limit}" "${GenMC}" ${GENMCFLAGS} "-${model}" "-${coherence}" \
+		"-nthreads=${n}" "-print-stats-json=${statsfile}" $genmc_args \
+		-- ${CFLAGS} ${clang_args} "${t}" 2>&1`
+	[[ $? -eq 124 ]] && echo "TO - - - -" && return
+	time=`echo "${out}" | awk '/time/ { print substr($4, 1, length($4)-1) }'`
+	execs=`echo "${out}" | awk '/complete executions/ { print $6 }'`
+	if [[ -n "${best}" ]] && (( $(echo "${time:-0} >= ${best}" | bc -l) ))
+	then
+	    continue
+	fi
+	best="${time:-0}"
+	rss=`awk '/peakRSSKB/ { gsub(/[^0-9]/, "", $2); print $2 }' "${statsfile}"`
+	instrs=`awk '/"instructions"/ { gsub(/[^0-9]/, "", $2); print $2 }' "${statsfile}"`
+	interp=`awk '/"interpreterMs"/ { gsub(/[^0-9.]/, "", $2); print $2 }' "${statsfile}"`
+	ms=""
+	for p in "${phases[@]}"
+	do
+	    ms="${ms} "`awk -v p="\"${p}\":" '$1 == p { gsub(/[^0-9.]/, "", $5); print $5 }' \
+			"${statsfile}"`
+	done
+	result="${best} ${execs:--} ${rss:--} ${instrs:--} ${interp:--}${ms}"
+    done
+    echo "${result}"
+}
+
+header="test,model,coherence,nthreads,time,executions,execs_per_sec,peak_rss_kb"
+for p in "${phases[@]}"
+do
+    header="${header},${p}_ms"
+done
+header="${header},instructions,minstrs_per_sec"
+
+printline
+printf "| ${CYAN}%-36s${NC} | ${CYAN}%-9s${NC} | ${CYAN}%-10s${NC} | ${CYAN}%-7s${NC} |\n" \
+       "Testcase" "Time" "Execs/sec" "Status"
+printline
+
+rows=()
+regressions=0
+for test in "${tests[@]}"
+do
+    dir="${testdir}/${test}"
+    model=`model_for "${test}"`
+    for coherence in ${coherences}
+    do
+	# Channels are only supported under -mo
+	[[ "${model}" == "mpsc" && "${coherence}" != "mo" ]] && continue
+	argsfile="${dir}/args.${model}.${coherence}.in"
+	test_args=""
+	[[ -f "${argsfile}" ]] && test_args=`head -n 1 "${argsfile}"`
+	genmc_args=$(echo "$test_args" | cut -f1 -d'|')
+	clang_args=$(echo "$test_args" | cut -f2 -d'|')
+	[[ -n "${bench_args[${test}]}" ]] && clang_args="${bench_args[${test}]}"
+	for n in ${nthreads}
+	do
+	    for t in $dir/variants/*.c
+	    do
+		read time execs rss instrs interp ms <<< `run_test`
+		key="${test}/${t##*/}"
+		rate="-"
+		if [[ "${time}" != "TO" && "${execs}" != "-" ]] &&
+		       (( $(echo "${time} > 0" | bc -l) ))
+		then
+		    rate=`echo "scale=2; ${execs}/${time}" | bc -l`
+		fi
+		# Instruction throughput is measured over the time spent
+		# in the interpreter, outside all phases
+		irate="-"
+		if [[ "${instrs}" != "-" && "${interp}" != "-" ]] &&
+		       (( $(echo "${interp} > 0" | bc -l) ))
+		then
+		    irate=`echo "scale=2; ${instrs}/${interp}/1000" | bc -l`
+		fi
+		row="${key},${model},${coherence},${n},${time},${execs},${rate},${rss},${ms// /,},${instrs},${irate}"
+		rows+=("${row}")
+
+		status="${GREEN}OK${NC}"
+		[[ "${time}" == "TO" ]] && status="${YELLOW}TO${NC}"
+		# Runs shorter than mintime are below the resolution of
+		# the reported time, so their rates are not compared
+		base=""
+		[[ -f "${baseline}" ]] &&
+		    base=`awk -F, -v k="${key}" -v m="${model}" -v c="${coherence}" -v n="${n}" \
+			   -v t="${mintime}" '$1 == k && $2 == m && $3 == c && $4 == n && $5 >= t { print $7 }' \
+			   "${baseline}"`
+		if [[ -n "${base}" && "${base}" != "-" ]] &&
+		       { [[ "${rate}" == "-" ]] ||
+			     (( $(echo "${rate} < ${base} * (100 - ${tolerance}) / 100" | bc -l) )); }
+		then
+		    status="${RED}SLOWER${NC}"
+		    regressions=$((regressions+1))
+		fi
+		printf "| ${POWDER_BLUE}%-36s${NC} | % 9s | % 10s | %-7s |\n" \
+		       "${key} (${coherence}, ${n})" "${time}" "${rate}" "${status}"
+	    done
+	done
+    done
+done
+printline
+
+if [[ "${format}" == "json" ]]
+then
+    {
+	echo "["
+	for ((i=0;i<${#rows[@]};i++))
+	do
+	    IFS=',' read -r -a f <<< "${rows[$i]}"
+	    printf '  {"test": "%s", "model": "%s", "coherence": "%s", "nthreads": %s, ' \
+		   "${f[0]}" "${f[1]}" "${f[2]}" "${f[3]}"
+	    printf '"time": "%s", "executions": "%s", "execsPerSec": "%s", "peakRSSKB": "%s", "phasesMs": {' \
+		   "${f[4]}" "${f[5]}" "${f[6]}" "${f[7]}"
+	    for ((j=0;j<${#phases[@]};j++))
+	    do
+		printf '%s"%s": "%s"' "$([[ $j -gt 0 ]] && echo ', ')" "${phases[$j]}" "${f[$((8+j))]}"
+	    done
+	    printf '}, "instructions": "%s", "minstrsPerSec": "%s"}%s\n' \
+		   "${f[$((8+${#phases[@]}))]}" "${f[$((9+${#phases[@]}))]}" \
+		   "$([[ $i -lt $((${#rows[@]}-1)) ]] && echo ',')"
+	done
+	echo "]"
+    } > "${output}"
+else
+    {
+	echo "${header}"
+	printf '%s\n' "${rows[@]}"
+    } > "${output}"
+fi
+echo "Results written to ${output}"
+
+if [[ "${regressions}" -gt 0 ]]
+then
+    echo "${RED}${regressions} configuration(s) slower than the baseline" \
+	 "by more than ${tolerance}%${NC}"
+    exit 1
+fi
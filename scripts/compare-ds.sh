@@ -0,0 +1,93 @@
+#!/bin/bash
+
+# Compares the running times of two GenMC binaries on the data-structures
+# testcases. Useful for measuring the effect of changes in the graph
+# internals (e.g., the read/receive indices of ExecutionGraph).
+#
+# Usage: GenMC_BASE=/path/to/old/genmc ./compare-ds.sh [runs]
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, you can access it online at
+# http://www.gnu.org/licenses/gpl-2.0.html.
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+GenMC="${GenMC:-$DIR/../src/genmc}"
+GenMC_BASE="${GenMC_BASE:?GenMC_BASE should point to the baseline binary}"
+
+source "${DIR}/terminal.sh"
+
+model="${model:-rc11}"
+coherence="${coherence:-wb}"
+testdir="${testdir:-${DIR}/../tests/correct/data-structures}"
+runs="${1:-3}"
+
+shopt -s nullglob
+
+# Prints the best (minimum) time reported by binary $1 over all runs
+best_time() {
+    best=""
+    for ((r=0;r<runs;r++))
+    do
+	output=`"$1" ${GENMCFLAGS} "-${model}" "-${coherence}" $genmc_args -- ${CFLAGS} ${clang_args} "${t}" 2>&1`
+	time=`echo "${output}" | awk '/time/ { print substr($4, 1, length($4)-1) }'`
+	time="${time}" && [[ -z "${time}" ]] && time=0
+	if [[ -z "${best}" ]] || (( $(echo "${time} < ${best}" | bc -l) ))
+	then
+	    best="${time}"
+	fi
+    done
+    echo "${best}"
+}
+
+printline
+printf "| ${CYAN}%-24s${NC} | ${CYAN}%-9s${NC} | ${CYAN}%-9s${NC} | ${CYAN}%-9s${NC} |\n" \
+       "Testcase" "Baseline" "Current" "Speedup"
+printline
+
+total_base=0
+total_curr=0
+for dir in "${testdir}"/*
+do
+    [[ -d "${dir}/variants" ]] || continue
+    argsfile="${dir}/args.${model}.${coherence}.in"
+    if [[ -f "${argsfile}" ]]
+    then
+	mapfile -t argslist < "${argsfile}"
+    else
+	argslist=("")
+    fi
+    for test_args in "${argslist[@]}"
+    do
+	genmc_args=$(echo "$test_args" | cut -f1 -d'|')
+	clang_args=$(echo "$test_args" | cut -f2 -d'|')
+	n=`echo ${test_args} |
+	     awk ' { if (match($0, /-DN=[0-9]+/)) print "/" substr($0, RSTART+4, RLENGTH-4) } '`
+	for t in $dir/variants/*.c
+	do
+	    base=`best_time "${GenMC_BASE}"`
+	    curr=`best_time "${GenMC}"`
+	    total_base=`echo "scale=2; ${total_base}+${base}" | bc -l`
+	    total_curr=`echo "scale=2; ${total_curr}+${curr}" | bc -l`
+	    speedup="-" && (( $(echo "${curr} > 0" | bc -l) )) &&
+		speedup=`echo "scale=2; ${base}/${curr}" | bc -l`
+	    printf "| ${POWDER_BLUE}%-24s${NC} | % 9s | % 9s | % 9s |\n" \
+		   "${dir##*/}${n}/${t##*/}" "${base}" "${curr}" "${speedup}"
+	done
+    done
+done
+
+printline
+speedup="-" && (( $(echo "${total_curr} > 0" | bc -l) )) &&
+    speedup=`echo "scale=2; ${total_base}/${total_curr}" | bc -l`
+printf "| %-24s | % 9s | % 9s | % 9s |\n" "Total" "${total_base}" "${total_curr}" "${speedup}"
+printline
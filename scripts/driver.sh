@@ -109,11 +109,11 @@ initialize_results
 
 # First, run the test cases in the correct/ directory
 correctdir="${DIR}/../tests/correct"
-for model in rc11 imm lkmm
+for model in rc11 imm lkmm mpsc
 do
     for coherence in wb mo
     do
-	for cat in infr litmus saver helper liveness synthetic data-structures fs lkmm # lapor
+	for cat in infr litmus saver helper liveness synthetic data-structures fs lkmm channels # lapor
 	do
 	    testdir="${correctdir}/${cat}"
 	    if [[ ("${model}" == "lkmm" && "${cat}" != "lkmm" && "${cat}" != "fs") ||
@@ -121,7 +121,12 @@ do
 	    then
 		continue
 	    fi
-	    if [[ "${cat}" == "liveness" && "${coherence}" != "mo" ]]
+	    if [[ ("${model}" == "mpsc" && "${cat}" != "channels") ||
+		  ("${model}" != "mpsc" && "${cat}" == "channels") ]]
+	    then
+		continue
+	    fi
+	    if [[ ("${cat}" == "liveness" || "${cat}" == "channels") && "${coherence}" != "mo" ]]
 	    then
 		continue
 	    fi
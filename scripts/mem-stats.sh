@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Prints the average memory footprint per graph event (as reported by
+# -print-mem-stats) for the litmus and data-structures testcases.
+# Run once per build (setting GenMC accordingly) to compare builds.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, you can access it online at
+# http://www.gnu.org/licenses/gpl-2.0.html.
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+GenMC="${GenMC:-$DIR/../src/genmc}"
+
+source "${DIR}/terminal.sh"
+
+model="${model:-rc11}"
+coherence="${coherence:-wb}"
+
+shopt -s nullglob
+
+printline
+printf "| ${CYAN}%-40s${NC} | ${CYAN}%-18s${NC} |\n" "Testcase" "Bytes/event"
+printline
+
+for cat in litmus data-structures
+do
+    for dir in "${DIR}/../tests/correct/${cat}"/*
+    do
+	[[ -d "${dir}/variants" ]] || continue
+	test_args="" && [[ -f "${dir}/args.${model}.${coherence}.in" ]] &&
+	    test_args=`head -n 1 "${dir}/args.${model}.${coherence}.in"`
+	genmc_args=$(echo "$test_args" | cut -f1 -d'|')
+	clang_args=$(echo "$test_args" | cut -f2 -d'|')
+	for t in $dir/variants/*.c
+	do
+	    output=`"${GenMC}" ${GENMCFLAGS} -print-mem-stats "-${model}" "-${coherence}" $genmc_args -- ${CFLAGS} ${clang_args} "${t}" 2>&1`
+	    bytes=`echo "${output}" | awk '/memory per event/ { print $5 }'`
+	    printf "| ${POWDER_BLUE}%-40s${NC} | % 18s |\n" "${cat}/${dir##*/}/${t##*/}" "${bytes:--}"
+	done
+    done
+done
+printline
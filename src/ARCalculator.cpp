@@ -46,14 +46,15 @@ bool ARCalculator::addArConstraints()
 void ARCalculator::initCalc()
 {
 	auto &g = getGraph();
-	auto &ar = g.getGlobalRelation(ExecutionGraph::RelationId::ar);
 
 	auto events = g.collectAllEvents([&](const EventLabel *lab)
 					 { return llvm::isa<MemAccessLabel>(lab) ||
 					   llvm::isa<FenceLabel>(lab) ||
 					   llvm::isa<LockLabelLAPOR>(lab) ||
 					   llvm::isa<UnlockLabelLAPOR>(lab); });
-	ar = Calculator::GlobalRelation(std::move(events));
+	auto &ar = g.resetGlobalRelation(ExecutionGraph::RelationId::ar,
+		Calculator::GlobalRelation(std::move(events),
+			g.getRelationBackend(ExecutionGraph::RelationId::ar)));
 	g.populatePPoRfEntries(ar);
 	ar.transClosure();
 	return;
@@ -25,12 +25,13 @@ void ARCalculatorLKMM::initCalc()
 {
 	auto &g = getGraph();
 	auto &prop = g.getGlobalRelation(ExecutionGraph::RelationId::prop);
-	auto &ar = g.getGlobalRelation(ExecutionGraph::RelationId::ar_lkmm);
 
 	/* ar should have the same events as prop -- runs after prop inits */
 	auto events = prop.getElems();
 
-	ar = Calculator::GlobalRelation(std::move(events));
+	auto &ar = g.resetGlobalRelation(ExecutionGraph::RelationId::ar_lkmm,
+		Calculator::GlobalRelation(std::move(events),
+			g.getRelationBackend(ExecutionGraph::RelationId::ar_lkmm)));
 	g.populatePPoRfEntries(ar);
 	ar.transClosure();
 	return;
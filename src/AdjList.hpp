@@ -21,7 +21,9 @@
 #ifndef __ADJ_LIST_HPP__
 #define __ADJ_LIST_HPP__
 
-#include <llvm/ADT/BitVector.h>
+#include "BitMatrix.hpp"
+#include "BitRow.hpp"
+#include "Error.hpp"
 #include <llvm/Support/raw_ostream.h>
 
 #include <functional>
@@ -29,6 +31,16 @@
 #include <unordered_set>
 #include <vector>
 
+/*
+ * The coordinates of an element, used by the dense backend of AdjList
+ * to number elements without hashing. Works for Event-like types.
+ */
+template <class T>
+struct DenseCoords {
+	static int thread(const T &a) { return a.thread; }
+	static int index(const T &a) { return a.index; }
+};
+
 template <class T, class Hash = std::hash<T> >
 class AdjList {
 
@@ -41,33 +53,17 @@ public:
 	enum class NodeStatus { unseen, entered, left };
 
 public:
+	/* The representation of node IDs and of the transitive closure */
+	enum class Backend {
+		sparse, /* Hashed IDs; one growable row per node */
+		dense,  /* IDs from (thread, index) prefix sums; one contiguous matrix */
+	};
+
 	AdjList() {}
-	AdjList(const std::vector<T> &es) : elems(es) {
-		auto size = elems.size();
-
-		nodeSucc.resize(size);
-		inDegree.resize(size);
-		transC.resize(size);
-		calculatedTransC = false;
-
-		for (auto i = 0u; i < size; i++) {
-			ids[elems[i]] = i;
-			transC[i].resize(size);
-		}
-	}
-	AdjList(std::vector<T> &&es) : elems(std::move(es)) {
-		auto size = elems.size();
-
-		nodeSucc.resize(size);
-		inDegree.resize(size);
-		transC.resize(size);
-		calculatedTransC = false;
-
-		for (auto i = 0u; i < size; i++) {
-			ids[elems[i]] = i;
-			transC[i].resize(size);
-		}
-	}
+	AdjList(const std::vector<T> &es, Backend b = Backend::sparse)
+		: elems(es), backend(b) { initNodes(); }
+	AdjList(std::vector<T> &&es, Backend b = Backend::sparse)
+		: elems(std::move(es)), backend(b) { initNodes(); }
 
 	/* Iterator typedefs */
 	using iterator = typename std::vector<T>::iterator;
@@ -94,7 +90,21 @@ public:
 	/* Returns the elements (nodes) of the graph */
 	const std::vector<T> &getElems() const { return elems; }
 
-	unsigned int getIndex(T a) const { return ids.at(a); }
+	unsigned int getIndex(T a) const {
+		if (backend == Backend::sparse)
+			return ids.at(a);
+		BUG_ON(!contains(a));
+		return slotIds[getSlot(a)];
+	}
+
+	/* Returns true if A is a node of the graph */
+	bool contains(T a) const {
+		return (backend == Backend::dense) ? hasSlot(a) && slotIds[getSlot(a)] != -1 :
+						     ids.count(a);
+	}
+
+	/* Returns the representation used by this graph */
+	Backend getBackend() const { return backend; }
 
 	/* Returns the number of elements in the graph */
 	unsigned int size() const { return elems.size(); }
@@ -111,6 +121,16 @@ public:
 	/* Helper for addEdge() that adds nodes with known IDs */
 	void addEdge(NodeId a, NodeId b);
 
+	/* Adds node A along with edges from each of PREDS to it.
+	 * Since A has no successors, an already calculated transitive
+	 * closure is kept up to date in place (in O(size * |PREDS|)) */
+	void addSinkNode(T a, const std::vector<T> &preds);
+
+	/* Adds the edge A -> B, keeping the transitive closure up to
+	 * date in place. Returns false (and leaves the graph intact)
+	 * if the edge would close a cycle */
+	bool addEdgeAcyclic(NodeId a, NodeId b);
+
 	/* For each "f" in "froms", adds edges to all the "tos"*/
 	void addEdgesFromTo(const std::vector<T> &froms, const std::vector<T> &tos);
 
@@ -123,6 +143,14 @@ public:
 		       nodeSucc[getIndex(a)].size() == 0;
 	}
 
+	/* Returns true if there is a (non-empty) path A -> ... -> B.
+	 * Follows the edges, so it works without the transitive closure */
+	bool hasPath(NodeId a, NodeId b) const;
+
+	/* Returns true if the graph has no cycles.
+	 * Works without the transitive closure, in O(nodes + edges) */
+	bool isAcyclic() const;
+
 	/* Performs a DFS exploration */
 	template<typename FVB, typename FET, typename FEB,
 		 typename FEF, typename FVE, typename FEND>
@@ -147,26 +175,61 @@ public:
 
 	void transClosure();
 
-	bool isIrreflexive();
+	bool isIrreflexive() const;
 
 	/* Returns true if the respective edge exists */
 	inline bool operator()(const T a, const T b) const {
-		return transC[getIndex(a)][getIndex(b)];
+		return reaches(getIndex(a), getIndex(b));
 	}
 	inline bool operator()(const T a, NodeId b) const {
-		return transC[getIndex(a)][b];
+		return reaches(getIndex(a), b);
 	}
 	inline bool operator()(NodeId a, const T b) const {
-		return transC[a][getIndex(b)];
+		return reaches(a, getIndex(b));
 	}
 	inline bool operator()(NodeId a, NodeId b) const {
-		return transC[a][b];
+		return reaches(a, b);
 	}
 
 	template<typename U, typename Z>
 	friend llvm::raw_ostream& operator<<(llvm::raw_ostream &s, const AdjList<U, Z> &l);
 
 private:
+	/* Sets up IDs and closure rows for the initial elements */
+	void initNodes();
+
+	/* Dense backend: (Re)builds the slot of each element */
+	void buildSlots();
+
+	/* Dense backend: Returns the slot of A, and whether it has one */
+	unsigned int getSlot(const T &a) const {
+		return threadSlots[DenseCoords<T>::thread(a)] + DenseCoords<T>::index(a);
+	}
+	bool hasSlot(const T &a) const {
+		auto t = DenseCoords<T>::thread(a);
+		auto i = DenseCoords<T>::index(a);
+		return 0 <= t && t + 1 < (int) threadSlots.size() &&
+		       0 <= i && threadSlots[t] + i < threadSlots[t + 1];
+	}
+
+	/* Accessors for the closure, regardless of the backend */
+	bool reaches(NodeId a, NodeId b) const {
+		return (backend == Backend::dense) ? matrix.test(a, b) : transC[a][b];
+	}
+	void setReaches(NodeId a, NodeId b) {
+		if (backend == Backend::dense)
+			matrix.set(a, b);
+		else
+			transC[a].set(b);
+	}
+	/* Whatever B reaches, A reaches as well */
+	void addReachesOf(NodeId a, NodeId b) {
+		if (backend == Backend::dense)
+			matrix.orRow(a, b);
+		else
+			transC[a] |= transC[b];
+	}
+
 	/* Helper for dfs() */
 	template<typename FVB, typename FET, typename FEB,
 		 typename FEF, typename FVE>
@@ -193,12 +256,21 @@ private:
 
 	std::vector<int> inDegree;
 
-	/* Map that maintains the ID of each element */
+	/* Map that maintains the ID of each element (sparse backend) */
 	std::unordered_map<T, NodeId, Hash> ids;
 
-	/* Maintain transitive closure info */
+	/* The ID of the element at slot threadSlots[thread] + index,
+	 * or -1 if there is no such element (dense backend) */
+	std::vector<int> threadSlots;
+	std::vector<int> slotIds;
+
+	/* Maintain transitive closure info (in transC for the sparse
+	 * backend, and in matrix for the dense one) */
 	bool calculatedTransC = false;
-	std::vector<llvm::BitVector> transC;
+	std::vector<BitRow> transC;
+	BitMatrix matrix;
+
+	Backend backend = Backend::sparse;
 };
 
 #include "AdjList.tcc"
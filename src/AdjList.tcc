@@ -20,18 +20,73 @@
 
 #include "Error.hpp"
 
+template<typename T, typename H>
+void AdjList<T, H>::buildSlots()
+{
+	std::vector<int> sizes;
+	for (auto &e : elems) {
+		auto t = DenseCoords<T>::thread(e);
+		auto i = DenseCoords<T>::index(e);
+		BUG_ON(t < 0 || i < 0);
+		if (t >= (int) sizes.size())
+			sizes.resize(t + 1, 0);
+		sizes[t] = std::max(sizes[t], i + 1);
+	}
+
+	threadSlots.assign(sizes.size() + 1, 0);
+	for (auto t = 0u; t < sizes.size(); t++)
+		threadSlots[t + 1] = threadSlots[t] + sizes[t];
+
+	slotIds.assign(threadSlots.back(), -1);
+	for (auto i = 0u; i < elems.size(); i++)
+		slotIds[getSlot(elems[i])] = i;
+	return;
+}
+
+template<typename T, typename H>
+void AdjList<T, H>::initNodes()
+{
+	auto size = elems.size();
+
+	nodeSucc.resize(size);
+	inDegree.resize(size);
+	calculatedTransC = false;
+
+	if (backend == Backend::dense) {
+		buildSlots();
+		matrix = BitMatrix(size);
+		return;
+	}
+
+	transC.resize(size);
+	for (auto i = 0u; i < size; i++) {
+		ids[elems[i]] = i;
+		transC[i].resize(size);
+	}
+	return;
+}
+
 template<typename T, typename H>
 void AdjList<T, H>::addNode(T a)
 {
 	auto id = elems.size();
 
-	ids[a] = id;
 	elems.push_back(a);
 	nodeSucc.push_back({});
 	inDegree.push_back(0);
-
 	calculatedTransC = false;
-	transC.push_back(llvm::BitVector(id));
+
+	if (backend == Backend::dense) {
+		if (hasSlot(a))
+			slotIds[getSlot(a)] = id;
+		else
+			buildSlots();
+		matrix.grow(id + 1);
+		return;
+	}
+
+	ids[a] = id;
+	transC.push_back(BitRow(id));
 	return;
 }
 
@@ -43,7 +98,7 @@ void AdjList<T, H>::addEdge(NodeId a, NodeId b)
 		return;
 
 	nodeSucc[a].push_back(b);
-	transC[a].set(b);
+	setReaches(a, b);
 	++inDegree[b];
 	calculatedTransC = false;
 	return;
@@ -56,6 +111,55 @@ void AdjList<T, H>::addEdge(T a, T b)
 	return;
 }
 
+template<typename T, typename H>
+void AdjList<T, H>::addSinkNode(T a, const std::vector<T> &preds)
+{
+	auto hadTransC = calculatedTransC;
+
+	addNode(a);
+	auto id = getIndex(a);
+	for (auto &p : preds)
+		addEdge(getIndex(p), id);
+
+	if (!hadTransC)
+		return;
+
+	/* Whatever reaches one of PREDS now reaches A as well */
+	for (auto i = 0u; i < id; i++) {
+		for (auto &p : preds) {
+			if (reaches(i, getIndex(p))) {
+				setReaches(i, id);
+				break;
+			}
+		}
+	}
+	calculatedTransC = true;
+	return;
+}
+
+template<typename T, typename H>
+bool AdjList<T, H>::addEdgeAcyclic(NodeId a, NodeId b)
+{
+	transClosure();
+	if (a == b || reaches(b, a))
+		return false;
+	if (reaches(a, b))
+		return true;
+
+	nodeSucc[a].push_back(b);
+	++inDegree[b];
+
+	/* Whatever reaches A now reaches B and its successors
+	 * (B's row is not among those updated, as B does not reach A) */
+	for (auto i = 0u; i < elems.size(); i++) {
+		if (i == a || reaches(i, a)) {
+			addReachesOf(i, b);
+			setReaches(i, b);
+		}
+	}
+	return true;
+}
+
 template<typename T, typename H>
 void AdjList<T, H>::addEdgesFromTo(const std::vector<T> &froms, const std::vector<T> &tos)
 {
@@ -64,6 +168,47 @@ void AdjList<T, H>::addEdgesFromTo(const std::vector<T> &froms, const std::vecto
 			addEdge(f, t);
 }
 
+template<typename T, typename H>
+bool AdjList<T, H>::hasPath(NodeId a, NodeId b) const
+{
+	std::vector<bool> visited(elems.size(), false);
+	std::vector<NodeId> workList(nodeSucc[a]);
+
+	while (!workList.empty()) {
+		auto i = workList.back();
+		workList.pop_back();
+		if (i == b)
+			return true;
+		if (visited[i])
+			continue;
+		visited[i] = true;
+		workList.insert(workList.end(), nodeSucc[i].begin(), nodeSucc[i].end());
+	}
+	return false;
+}
+
+template<typename T, typename H>
+bool AdjList<T, H>::isAcyclic() const
+{
+	/* Kahn's algorithm: the graph is acyclic iff all nodes get sorted */
+	auto inDegree(getInDegrees());
+	std::vector<NodeId> workList;
+	for (auto i = 0u; i < elems.size(); i++)
+		if (inDegree[i] == 0)
+			workList.push_back(i);
+
+	auto sorted = 0u;
+	while (!workList.empty()) {
+		auto i = workList.back();
+		workList.pop_back();
+		++sorted;
+		for (auto j : nodeSucc[i])
+			if (--inDegree[j] == 0)
+				workList.push_back(j);
+	}
+	return sorted == elems.size();
+}
+
 template<typename T, typename H>
 const std::vector<int> &AdjList<T, H>::getInDegrees() const
 {
@@ -280,6 +425,12 @@ void AdjList<T, H>::transClosure()
 	if (calculatedTransC)
 		return;
 
+	if (backend == Backend::dense) {
+		matrix.transClosure();
+		calculatedTransC = true;
+		return;
+	}
+
 	dfs([&](NodeId i, Timestamp &t, std::vector<NodeStatus> &m,
 		std::vector<NodeId> &p, std::vector<Timestamp> &d,
 		std::vector<Timestamp> &f){ return; }, /* atEntryV */
@@ -309,10 +460,10 @@ void AdjList<T, H>::transClosure()
 }
 
 template<typename T, typename H>
-bool AdjList<T, H>::isIrreflexive()
+bool AdjList<T, H>::isIrreflexive() const
 {
 	for (auto i = 0u; i < getElems().size(); i++)
-		if (transC[i][i])
+		if (reaches(i, i))
 			return false;
 	return true;
 }
@@ -340,8 +491,8 @@ llvm::raw_ostream& operator<<(llvm::raw_ostream &s, const AdjList<T, H> &l)
 	s << "Transitive closure:\n";
 	for (auto i = 0u; i < elems.size(); i++) {
 		s << elems[i] << " -> ";
-		for (auto j = 0u; j < l.transC[i].size(); j++)
-			if (l.transC[i][j])
+		for (auto j = 0u; j < elems.size(); j++)
+			if (l(i, j))
 				s << elems[j] << " ";
 		s << "\n";
 	}
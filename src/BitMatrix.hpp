@@ -0,0 +1,130 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __BIT_MATRIX_HPP__
+#define __BIT_MATRIX_HPP__
+
+#include "Error.hpp"
+#include "SIMDKernels.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+/*******************************************************************************
+ **                             BitMatrix Class
+ ******************************************************************************/
+
+/*
+ * A square bit matrix stored in a single contiguous buffer. Rows are
+ * padded to whole cache lines and the buffer is cache-line aligned, so
+ * that rows can be combined with the vectorized kernels of SIMDKernels
+ * using aligned accesses. Used as the dense backend of AdjList.
+ */
+class BitMatrix {
+
+public:
+	using Word = uint64_t;
+
+	BitMatrix() = default;
+	BitMatrix(unsigned int n) { grow(n); }
+
+	/* Returns the number of rows (and columns) */
+	unsigned int size() const { return n; }
+
+	/* Grows the matrix to N x N, preserving its contents */
+	void grow(unsigned int n);
+
+	bool test(unsigned int i, unsigned int j) const {
+		return (row(i)[j / wordBits] >> (j % wordBits)) & 1;
+	}
+
+	void set(unsigned int i, unsigned int j) {
+		row(i)[j / wordBits] |= (Word) 1 << (j % wordBits);
+	}
+
+	/* Row I |= row J */
+	void orRow(unsigned int i, unsigned int j) {
+		SIMDKernels::orInto(row(i), row(j), rowWords);
+	}
+
+	/* Calculates the transitive closure in place (Warshall) */
+	void transClosure() {
+		for (auto k = 0u; k < n; k++)
+			for (auto i = 0u; i < n; i++)
+				if (i != k && test(i, k))
+					orRow(i, k);
+	}
+
+private:
+	static constexpr unsigned int wordBits = 64;
+	static constexpr unsigned int lineWords = 8; /* 64-byte lines */
+
+	/* An allocator returning cache-line-aligned storage */
+	template<typename T>
+	struct AlignedAllocator {
+		using value_type = T;
+
+		AlignedAllocator() = default;
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U> &) {}
+
+		T *allocate(std::size_t n) {
+			void *p = nullptr;
+			if (posix_memalign(&p, lineWords * sizeof(Word), n * sizeof(T)))
+				ERROR("Could not allocate memory for a relation matrix!\n");
+			return static_cast<T *>(p);
+		}
+		void deallocate(T *p, std::size_t) { free(p); }
+
+		template<typename U>
+		bool operator==(const AlignedAllocator<U> &) const { return true; }
+		template<typename U>
+		bool operator!=(const AlignedAllocator<U> &) const { return false; }
+	};
+
+	Word *row(unsigned int i) { return &words[(size_t) i * rowWords]; }
+	const Word *row(unsigned int i) const { return &words[(size_t) i * rowWords]; }
+
+	unsigned int n = 0;
+	unsigned int rowWords = 0;
+	std::vector<Word, AlignedAllocator<Word> > words;
+};
+
+inline void BitMatrix::grow(unsigned int m)
+{
+	if (m <= n)
+		return;
+
+	auto lines = (m + lineWords * wordBits - 1) / (lineWords * wordBits);
+	auto newRowWords = lines * lineWords;
+	if (newRowWords == rowWords) {
+		words.resize((size_t) m * rowWords, 0);
+		n = m;
+		return;
+	}
+
+	std::vector<Word, AlignedAllocator<Word> > nw((size_t) m * newRowWords, 0);
+	for (auto i = 0u; i < n; i++)
+		std::copy(row(i), row(i) + rowWords, &nw[(size_t) i * newRowWords]);
+	words = std::move(nw);
+	rowWords = newRowWords;
+	n = m;
+}
+
+#endif /* __BIT_MATRIX_HPP__ */
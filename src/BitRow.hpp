@@ -0,0 +1,98 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __BIT_ROW_HPP__
+#define __BIT_ROW_HPP__
+
+#include "SIMDKernels.hpp"
+#include <llvm/ADT/SmallVector.h>
+#include <cstdint>
+
+/*******************************************************************************
+ **                             BitRow Class
+ ******************************************************************************/
+
+/*
+ * A growable bitset used for the rows of bit matrices (e.g., transitive
+ * closures). Unlike llvm::BitVector, it exposes its words, so that rows
+ * can be combined with the vectorized kernels of SIMDKernels. Bits past
+ * the end of a row read as unset, and rows grow as necessary when set
+ * or combined with longer rows.
+ */
+class BitRow {
+
+public:
+	using Word = uint64_t;
+
+	BitRow() = default;
+	BitRow(unsigned int n) { resize(n); }
+
+	/* Returns the number of bits in this row */
+	unsigned int size() const { return nbits; }
+
+	void resize(unsigned int n) {
+		nbits = n;
+		words.resize(wordsFor(n), 0);
+		clearUnusedBits();
+	}
+
+	bool test(unsigned int i) const {
+		return i < nbits && (words[i / wordBits] >> (i % wordBits)) & 1;
+	}
+	bool operator[](unsigned int i) const { return test(i); }
+
+	void set(unsigned int i) {
+		if (i >= nbits)
+			resize(i + 1);
+		words[i / wordBits] |= (Word) 1 << (i % wordBits);
+	}
+
+	BitRow &operator|=(const BitRow &other) {
+		if (other.nbits > nbits)
+			resize(other.nbits);
+		auto n = other.words.size();
+		if (n < 8) {
+			/* Not worth a call to the vectorized kernel */
+			for (auto i = 0u; i < n; i++)
+				words[i] |= other.words[i];
+		} else {
+			SIMDKernels::orInto(words.data(), other.words.data(), n);
+		}
+		return *this;
+	}
+
+	/* Returns the words of this row */
+	const Word *data() const { return words.data(); }
+	Word *data() { return words.data(); }
+	unsigned int numWords() const { return words.size(); }
+
+private:
+	static constexpr unsigned int wordBits = 64;
+
+	static unsigned int wordsFor(unsigned int n) { return (n + wordBits - 1) / wordBits; }
+
+	void clearUnusedBits() {
+		if (nbits % wordBits)
+			words.back() &= ((Word) 1 << (nbits % wordBits)) - 1;
+	}
+
+	llvm::SmallVector<Word, 4> words;
+	unsigned int nbits = 0;
+};
+
+#endif /* __BIT_ROW_HPP__ */
@@ -79,6 +79,15 @@ public:
 	/* The calculator is informed about the removal of some events */
 	virtual void removeAfter(const VectorClock &preds) = 0;
 
+	/* Whether the calculation only reads the graph (and hb) and only
+	 * writes the calculator's own relation, so that it can run
+	 * alongside other such calculators */
+	virtual bool isIndependent() const { return false; }
+
+	/* Records statistics about the last initialization. Called on the
+	 * checking thread, even if initCalc() ran on a helper */
+	virtual void recordStats() const {}
+
 	virtual std::unique_ptr<Calculator> clone(ExecutionGraph &g) const = 0;
 
 private:
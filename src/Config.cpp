@@ -26,6 +26,7 @@
 #include <llvm/Support/raw_ostream.h>
 
 #include <thread>
+#include <unordered_set>
 
 /*** Command-line argument categories ***/
 
@@ -70,6 +71,29 @@ static llvm::cl::opt<unsigned int>
 clThreads("nthreads", llvm::cl::cat(clGeneral), llvm::cl::init(1),
 	      llvm::cl::desc("Number of threads to be used in the exploration"));
 
+static llvm::cl::opt<SplitPolicy>
+clSplitPolicy("split-policy", llvm::cl::cat(clGeneral), llvm::cl::init(SplitPolicy::fixed),
+	      llvm::cl::desc("Choose when revisits are handed to other threads:"),
+	      llvm::cl::values(
+		      clEnumValN(SplitPolicy::fixed,    "fixed",    "While few tasks are pending (default)"),
+		      clEnumValN(SplitPolicy::adaptive, "adaptive", "Based on measured task times"),
+		      clEnumValN(SplitPolicy::depth,    "depth",    "Up to a revisit depth (see -split-depth)")
+		      ));
+
+static llvm::cl::opt<unsigned int>
+clSplitDepth("split-depth", llvm::cl::cat(clGeneral), llvm::cl::init(4), llvm::cl::value_desc("N"),
+	     llvm::cl::desc("Hand revisits to other threads only up to depth N (-split-policy=depth)"));
+
+static llvm::cl::opt<unsigned int>
+clConsThreads("consistency-threads", llvm::cl::cat(clGeneral), llvm::cl::init(1), llvm::cl::value_desc("N"),
+	      llvm::cl::desc("Number of threads to split each consistency check across"));
+
+static llvm::cl::opt<unsigned int>
+clCheckpointInterval("checkpoint-interval", llvm::cl::cat(clGeneral), llvm::cl::init(0),
+		     llvm::cl::value_desc("N"),
+		     llvm::cl::desc("Snapshot the interpreter every N events of a thread, "
+				    "so that replays resume from there (0 disables)"));
+
 static llvm::cl::opt<bool>
 clLAPOR("lapor", llvm::cl::cat(clGeneral),
 	llvm::cl::desc("Enable Lock-Aware Partial Order Reduction (LAPOR)"));
@@ -120,6 +144,9 @@ static llvm::cl::opt<bool>
 clDisableBAM("disable-bam", llvm::cl::cat(clGeneral),
 	     llvm::cl::desc("Disable optimized barrier handling (BAM)"));
 static llvm::cl::opt<bool>
+clDisableIncrementalCons("disable-incremental-consistency", llvm::cl::cat(clGeneral),
+			 llvm::cl::desc("Recalculate hb from scratch at each consistency check"));
+static llvm::cl::opt<bool>
 clDisableStopOnSystemError("disable-stop-on-system-error", llvm::cl::cat(clGeneral),
 			   llvm::cl::desc("Do not stop verification on system errors"));
 
@@ -247,6 +274,41 @@ static llvm::cl::opt<bool>
 clPrintExecGraphs("print-exec-graphs", llvm::cl::cat(clDebugging),
 		  llvm::cl::desc("Print explored execution graphs"));
 
+static llvm::cl::opt<bool>
+clPrintPoolStats("print-pool-stats", llvm::cl::cat(clDebugging),
+		 llvm::cl::desc("Print per-worker statistics of the thread pool"));
+
+static llvm::cl::opt<bool>
+clPrintMemStats("print-mem-stats", llvm::cl::cat(clDebugging),
+		llvm::cl::desc("Print the average memory footprint of graph events"));
+
+static llvm::cl::opt<bool>
+clPrintStats("print-stats", llvm::cl::cat(clDebugging),
+	     llvm::cl::desc("Print timings and counters of the exploration"));
+
+static llvm::cl::opt<std::string>
+clStatsFile("print-stats-json", llvm::cl::init(""), llvm::cl::value_desc("file"),
+	    llvm::cl::cat(clDebugging),
+	    llvm::cl::desc("Dump timings and counters of the exploration to a file (JSON format)"));
+
+static llvm::cl::opt<bool>
+clPrintChannelStats("print-channel-stats", llvm::cl::cat(clDebugging),
+		    llvm::cl::desc("Print which send-order check each channel went through"));
+
+static llvm::cl::opt<unsigned int>
+clTraceSize("trace-size", llvm::cl::init(0), llvm::cl::value_desc("N"),
+	    llvm::cl::cat(clDebugging),
+	    llvm::cl::desc("Trace the last N channel operations, revisits and blockings of each worker"));
+
+static llvm::cl::opt<bool>
+clEnumerateExtensions("enumerate-extensions", llvm::cl::cat(clDebugging),
+		      llvm::cl::desc("Check full consistency by enumerating all co/lb extensions (slow)"));
+
+static llvm::cl::list<std::string>
+clDenseRelations("dense-relations", llvm::cl::CommaSeparated, llvm::cl::value_desc("rel"),
+		 llvm::cl::cat(clDebugging),
+		 llvm::cl::desc("Use a dense bit matrix for these relations (e.g., hb,psc,ar)"));
+
 
 #ifdef ENABLE_GENMC_DEBUG
 static llvm::cl::opt<bool>
@@ -305,12 +367,26 @@ void Config::checkConfigOptions() const
 	if (clLAPOR) {
 		ERROR("LAPOR is temporarily disabled.\n");
 	}
+	if (clThreads <= 1 && clSplitPolicy != SplitPolicy::fixed) {
+		WARN("--split-policy used without -nthreads.\n");
+	}
 	if (clHelper && clSchedulePolicy == SchedulePolicy::random) {
 		ERROR("Helper cannot be used with -schedule-policy=random.\n");
 	}
 	if (clHelper && clCoherenceType != CoherenceType::mo) {
 		ERROR("Helper can only be used with -mo.\n");
 	}
+	if (clModelType == ModelType::mpsc && clCoherenceType != CoherenceType::mo) {
+		ERROR("-mpsc can only be used with -mo.\n");
+	}
+	for (auto &r : clDenseRelations) {
+		static const std::unordered_set<std::string> rels = {
+			"hb", "psc", "ar", "prop", "ar_lkmm", "pb", "rcu_link",
+			"rcu", "rcu_fence", "xb", "mpsc",
+		};
+		if (!rels.count(r))
+			ERROR("Unknown relation for -dense-relations: " + r + "\n");
+	}
 
 	/* Check debugging options */
 	if (clSchedulePolicy != SchedulePolicy::random && clPrintRandomScheduleSeed) {
@@ -337,6 +413,10 @@ void Config::saveConfigOptions()
 	isDepTrackingModel = (model == ModelType::imm || model == ModelType::lkmm);
 	coherence = clCoherenceType;
 	threads = clThreads;
+	splitPolicy = clSplitPolicy;
+	splitDepth = clSplitDepth;
+	consThreads = clConsThreads;
+	checkpointInterval = clCheckpointInterval;
 	LAPOR = clLAPOR;
 	symmetryReduction = clSymmetryReduction;
 	helper = clHelper;
@@ -346,6 +426,7 @@ void Config::saveConfigOptions()
 	checkLiveness = clCheckLiveness;
 	disableRaceDetection = clDisableRaceDetection;
 	disableBAM = clDisableBAM;
+	disableIncrementalCons = clDisableIncrementalCons;
 	disableStopOnSystemError = clDisableStopOnSystemError;
 
 	/* Save persistency options */
@@ -375,6 +456,14 @@ void Config::saveConfigOptions()
 	printRandomScheduleSeed = clPrintRandomScheduleSeed;
 	randomScheduleSeed = clRandomScheduleSeed;
 	printExecGraphs = clPrintExecGraphs;
+	printPoolStats = clPrintPoolStats;
+	printMemStats = clPrintMemStats;
+	printChannelStats = clPrintChannelStats;
+	printStats = clPrintStats;
+	statsFile = clStatsFile;
+	traceSize = clTraceSize;
+	enumerateExtensions = clEnumerateExtensions;
+	denseRelations.insert(denseRelations.end(), clDenseRelations.begin(), clDenseRelations.end());
 	inputFromBitcodeFile = clInputFromBitcodeFile;
 	transformFile = clTransformFile;
 #ifdef ENABLE_GENMC_DEBUG
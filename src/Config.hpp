@@ -29,6 +29,7 @@
 
 enum class ModelType { rc11, imm, lkmm, mpsc };
 enum class SchedulePolicy { ltr, wf, random };
+enum class SplitPolicy { fixed, adaptive, depth };
 #ifdef ENABLE_GENMC_DEBUG
 enum class VerbosityLevel { V0, V1, V2, V3 };
 #endif
@@ -45,6 +46,10 @@ public:
 	bool isDepTrackingModel;
 	CoherenceType coherence;
 	unsigned int threads;
+	SplitPolicy splitPolicy;
+	unsigned int splitDepth;
+	unsigned int consThreads;
+	unsigned int checkpointInterval;
 	bool LAPOR;
 	bool symmetryReduction;
 	bool helper;
@@ -55,6 +60,7 @@ public:
 	std::string dotFile;
 	bool disableRaceDetection;
 	bool disableBAM;
+	bool disableIncrementalCons;
 	bool disableStopOnSystemError;
 
 	/*** Persistency options ***/
@@ -80,6 +86,14 @@ public:
 	/*** Debugging options ***/
 	bool inputFromBitcodeFile;
 	bool printExecGraphs;
+	bool printPoolStats;
+	bool printMemStats;
+	bool printChannelStats;
+	bool printStats;
+	std::string statsFile;
+	unsigned int traceSize;
+	bool enumerateExtensions;
+	std::vector<std::string> denseRelations;
 	SchedulePolicy schedulePolicy;
 	std::string randomScheduleSeed;
 	bool printRandomScheduleSeed;
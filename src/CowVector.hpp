@@ -0,0 +1,91 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __COW_VECTOR_HPP__
+#define __COW_VECTOR_HPP__
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+ * A vector whose elements are shared between copies and only
+ * duplicated when a copy writes to them. Copying the vector itself
+ * only copies pointers, so snapshots of large elements are cheap.
+ *
+ * Mutable element access always goes through operator[], which
+ * detaches the element if it is shared; references obtained that way
+ * must not be kept across copies of the vector.
+ */
+template<class T>
+class CowVector {
+
+public:
+	using size_type = typename std::vector<std::shared_ptr<T> >::size_type;
+
+	CowVector() = default;
+
+	size_type size() const { return elems.size(); }
+	bool empty() const { return elems.empty(); }
+
+	void push_back(T &&t) { elems.push_back(std::make_shared<T>(std::move(t))); }
+
+	T &operator[](size_type i) {
+		detach(i);
+		return *elems[i];
+	}
+	const T &operator[](size_type i) const { return *elems[i]; }
+
+	/* Replaces the i-th element without copying it first */
+	void assign(size_type i, T &&t) {
+		if (isShared(i))
+			elems[i] = std::make_shared<T>(std::move(t));
+		else
+			*elems[i] = std::move(t);
+	}
+
+	/* Makes the i-th element share the object P points to */
+	void share(size_type i, const std::shared_ptr<T> &p) { elems[i] = p; }
+
+	/* Empties the i-th element without copying it first */
+	void clear(size_type i) {
+		if (isShared(i))
+			elems[i] = std::make_shared<T>();
+		else
+			elems[i]->clear();
+	}
+
+	/* Whether the i-th element is shared with another copy */
+	bool isShared(size_type i) const {
+		if (elems[i].use_count() > 1)
+			return true;
+		/* Synchronize with the release of the last other owner */
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return false;
+	}
+
+private:
+	void detach(size_type i) {
+		if (isShared(i))
+			elems[i] = std::make_shared<T>(*elems[i]);
+	}
+
+	std::vector<std::shared_ptr<T> > elems;
+};
+
+#endif /* __COW_VECTOR_HPP__ */
@@ -26,18 +26,12 @@ std::vector<Event> DepExecutionGraph::getRevisitable(const WriteLabel *sLab) con
 	auto pendingRMW = getPendingRMW(sLab);
 	std::vector<Event> loads;
 
-	for (auto i = 0u; i < getNumThreads(); i++) {
-		if (sLab->getThread() == i)
+	for (auto &r : getReadsFromLoc(sLab->getAddr())) {
+		if (r.thread == sLab->getThread() || sLab->getPPoRfView().contains(r))
 			continue;
-		for (auto j = 1u; j < getThreadSize(i); j++) {
-			const EventLabel *lab = getEventLabel(Event(i, j));
-			if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
-				if (rLab->getAddr() == sLab->getAddr() &&
-				    !sLab->getPPoRfView().contains(rLab->getPos()) &&
-				    rLab->isRevisitable() && rLab->wasAddedMax())
-					loads.push_back(rLab->getPos());
-			}
-		}
+		auto *rLab = getReadLabel(r);
+		if (rLab->isRevisitable() && rLab->wasAddedMax())
+			loads.push_back(r);
 	}
 	if (!pendingRMW.isInitializer())
 		loads.erase(std::remove_if(loads.begin(), loads.end(), [&](Event &e){
@@ -206,6 +200,8 @@ DepExecutionGraph::getPrefixLabelsNotBefore(const WriteLabel *sLab,
 
 void DepExecutionGraph::cutToStamp(unsigned int stamp)
 {
+	noteNonAdditiveChange();
+
 	/* First remove events from the modification order */
 	auto preds = getDepViewFromStamp(stamp);
 
@@ -247,6 +243,7 @@ void DepExecutionGraph::cutToStamp(unsigned int stamp)
 				if (getEventLabel(pj)) /* Make sure the parent exists */
 					resetJoin(pj);
 			}
+			unindexLabel(lab);
 			setEventLabel(Event(i, j), nullptr);
 		}
 		resizeThread(i, newMax);
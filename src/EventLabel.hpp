@@ -26,6 +26,7 @@
 #include "value_ptr.hpp"
 #include "DepView.hpp"
 #include "InterpreterEnumAPI.hpp"
+#include "LabelAllocator.hpp"
 #include "ModuleID.hpp"
 #include "NameInfo.hpp"
 #include "MemAccess.hpp"
@@ -229,6 +230,15 @@ public:
 
 	virtual ~EventLabel() = default;
 
+	/* Labels are allocated from pools (the destructor being virtual,
+	 * the size passed to delete is the one of the dynamic type) */
+	static void *operator new(std::size_t size) {
+		return LabelAllocator::allocate(size);
+	}
+	static void operator delete(void *p, std::size_t size) {
+		LabelAllocator::deallocate(p, size);
+	}
+
 	/* Returns a clone object (virtual to allow deep copying from base) */
 	virtual std::unique_ptr<EventLabel> clone() const = 0;
 
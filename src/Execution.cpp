@@ -47,6 +47,7 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/GetElementPtrTypeIterator.h"
 #include "llvm/IR/InlineAsm.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -103,8 +104,24 @@ if (auto *iTyp = llvm::dyn_cast<IntegerType>(typ))			\
 	__result;							\
 })
 
-static void SetValue(Value *V, GenericValue Val, ExecutionContext &SF) {
-  SF.Values[V] = Val;
+void Interpreter::SetValue(Value *V, GenericValue Val, ExecutionContext &SF) {
+  /* Threads whose function takes no arguments get a NULL argument */
+  if (!V)
+    return;
+
+  getAssignedSlot(V, SF) = std::move(Val);
+}
+
+GenericValue &Interpreter::getAssignedSlot(Value *V, ExecutionContext &SF)
+{
+  auto slot = getFrameSlot(V);
+  if (slot >= SF.Values.size()) {
+    auto size = std::max(slot + 1, frameSizes.lookup(SF.CurFunction));
+    SF.Values.resize(size);
+    SF.Assigned.resize(size);
+  }
+  SF.Assigned[slot] = true;
+  return SF.Values[slot];
 }
 
 bool Interpreter::isStaticallyAllocated(SAddr addr) const
@@ -208,17 +225,27 @@ std::unique_ptr<SExpr<unsigned int>> Interpreter::getCurrentAnnotConcretized()
 		return nullptr;
 
 	using Concretizer = SExprConcretizer<AnnotID>;
-	auto &stackVals = ECStack().back().Values;
+	auto &SF = ECStack().back();
 	Concretizer::ReplaceMap vMap;
 
-	for (auto &kv : stackVals) {
-		/* (1) Check against NULL due to possibly empty thread parameter list
-		 * (2) Ensure that the load itself will not be concretized */
-		if (kv.first && kv.first != l) {
-			vMap.insert({(MI->idInfo.VID.at(kv.first)),
-					std::make_pair(GV_TO_SVAL(kv.second, kv.first->getType()),
-						       ASize(getTypeSize(kv.first->getType()) * 8))});
-		}
+	for (auto id : SExprRegCollector<AnnotID>().collect(annot)) {
+		auto it = MI->idInfo.IDV.find(id);
+		if (it == MI->idInfo.IDV.end() || vMap.count(id))
+			continue;
+
+		/* Ensure that the load itself will not be concretized, and
+		 * leave values not (yet) computed in this frame symbolic */
+		auto *v = it->second;
+		auto *i = dyn_cast<Instruction>(v);
+		auto *a = dyn_cast<Argument>(v);
+		if (v == l || !((i && i->getFunction() == SF.CurFunction) ||
+				(a && a->getParent() == SF.CurFunction)))
+			continue;
+		auto slot = getFrameSlot(v);
+		if (slot >= SF.Assigned.size() || !SF.Assigned[slot])
+			continue;
+		vMap.insert({id, std::make_pair(GV_TO_SVAL(SF.Values[slot], v->getType()),
+						ASize(getTypeSize(v->getType()) * 8))});
 	}
 	return Concretizer().concretize(annot, vMap);
 }
@@ -489,6 +516,143 @@ static void executeFRemInst(GenericValue &Dest, GenericValue Src1,
   }
 }
 
+//===----------------------------------------------------------------------===//
+//                Fast path for integers of up to 64 bits
+//===----------------------------------------------------------------------===//
+//
+// Almost all values are integers of at most 64 bits, or pointers. For these,
+// operands are read as plain words and the operations below are performed
+// directly on them, instead of on APInts built from GenericValue copies.
+// A word holds the value zero-extended to 64 bits.
+
+static bool isSmallIntType(const Type *Ty)
+{
+  return Ty->isIntegerTy() && Ty->getIntegerBitWidth() <= 64;
+}
+
+static uint64_t truncToWidth(uint64_t v, unsigned w)
+{
+  return (w == 64) ? v : v & ((UINT64_C(1) << w) - 1);
+}
+
+static int64_t sextFromWidth(uint64_t v, unsigned w)
+{
+  return (w == 64) ? (int64_t) v : ((int64_t) (v << (64 - w))) >> (64 - w);
+}
+
+/* Performs the binary operation OPC on words of width W. Returns false
+ * if the operation is not handled (e.g., divisions by zero), in which
+ * case the general path has to be taken */
+static bool executeSmallIntBinOp(unsigned opc, uint64_t a, uint64_t b, unsigned w,
+                                 uint64_t &r)
+{
+  switch (opc) {
+  case Instruction::Add:  r = a + b; break;
+  case Instruction::Sub:  r = a - b; break;
+  case Instruction::Mul:  r = a * b; break;
+  case Instruction::And:  r = a & b; break;
+  case Instruction::Or:   r = a | b; break;
+  case Instruction::Xor:  r = a ^ b; break;
+  case Instruction::UDiv:
+  case Instruction::URem:
+    if (b == 0)
+      return false;
+    r = (opc == Instruction::UDiv) ? a / b : a % b;
+    break;
+  case Instruction::SDiv:
+  case Instruction::SRem: {
+    if (b == 0)
+      return false;
+    auto sa = sextFromWidth(a, w);
+    auto sb = sextFromWidth(b, w);
+    /* Avoid INT64_MIN / -1, which traps; it wraps around in LLVM */
+    if (sb == -1)
+      r = (opc == Instruction::SDiv) ? -a : 0;
+    else
+      r = (opc == Instruction::SDiv) ? sa / sb : sa % sb;
+    break;
+  }
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr: {
+    /* Same rule for oversized shifts as getShiftAmount() */
+    auto amt = (b < w) ? b : (NextPowerOf2(w - 1) - 1) & b;
+    if (amt >= w)
+      r = (opc == Instruction::AShr && sextFromWidth(a, w) < 0) ? ~UINT64_C(0) : 0;
+    else if (opc == Instruction::Shl)
+      r = a << amt;
+    else if (opc == Instruction::LShr)
+      r = a >> amt;
+    else
+      r = sextFromWidth(a, w) >> amt;
+    break;
+  }
+  default:
+    return false;
+  }
+  r = truncToWidth(r, w);
+  return true;
+}
+
+/* Evaluates the integer predicate P on words of width W */
+static bool executeSmallICmp(CmpInst::Predicate p, uint64_t a, uint64_t b, unsigned w)
+{
+  switch (p) {
+  case ICmpInst::ICMP_EQ:  return a == b;
+  case ICmpInst::ICMP_NE:  return a != b;
+  case ICmpInst::ICMP_ULT: return a < b;
+  case ICmpInst::ICMP_UGT: return a > b;
+  case ICmpInst::ICMP_ULE: return a <= b;
+  case ICmpInst::ICMP_UGE: return a >= b;
+  case ICmpInst::ICMP_SLT: return sextFromWidth(a, w) < sextFromWidth(b, w);
+  case ICmpInst::ICMP_SGT: return sextFromWidth(a, w) > sextFromWidth(b, w);
+  case ICmpInst::ICMP_SLE: return sextFromWidth(a, w) <= sextFromWidth(b, w);
+  case ICmpInst::ICMP_SGE: return sextFromWidth(a, w) >= sextFromWidth(b, w);
+  default:
+    dbgs() << "Don't know how to handle this ICmp predicate!\n";
+    llvm_unreachable(nullptr);
+  }
+}
+
+uint64_t Interpreter::getSmallOperandValue(Value *V, ExecutionContext &SF)
+{
+  if (auto *CI = dyn_cast<ConstantInt>(V))
+    return CI->getZExtValue();
+  if (isa<Argument>(V) || isa<Instruction>(V)) {
+    auto slot = getFrameSlot(V);
+    if (slot >= SF.Values.size())
+      return 0;
+    auto &val = SF.Values[slot];
+    return V->getType()->isPointerTy() ? (uint64_t) (uintptr_t) val.PointerVal :
+      val.IntVal.getZExtValue();
+  }
+  auto val = getOperandValue(V, SF);
+  return V->getType()->isPointerTy() ? (uint64_t) (uintptr_t) val.PointerVal :
+    val.IntVal.getZExtValue();
+}
+
+void Interpreter::setSmallIntValue(Value *V, unsigned w, uint64_t val, ExecutionContext &SF)
+{
+  getAssignedSlot(V, SF).IntVal = APInt(w, val);
+}
+
+bool Interpreter::executeSmallIntInst(BinaryOperator &I, ExecutionContext &SF)
+{
+  if (!isSmallIntType(I.getType()))
+    return false;
+
+  auto w = I.getType()->getIntegerBitWidth();
+  uint64_t r;
+  if (!executeSmallIntBinOp(I.getOpcode(), getSmallOperandValue(I.getOperand(0), SF),
+                            getSmallOperandValue(I.getOperand(1), SF), w, r))
+    return false;
+
+  updateDataDeps(getCurThr().id, &I, I.getOperand(0));
+  updateDataDeps(getCurThr().id, &I, I.getOperand(1));
+  setSmallIntValue(&I, w, r, SF);
+  return true;
+}
+
 #define IMPLEMENT_INTEGER_ICMP(OP, TY) \
    case Type::IntegerTyID:  \
       Dest.IntVal = APInt(1,Src1.IntVal.OP(Src2.IntVal)); \
@@ -656,6 +820,19 @@ static GenericValue executeICMP_SGE(GenericValue Src1, GenericValue Src2,
 void Interpreter::visitICmpInst(ICmpInst &I) {
   ExecutionContext &SF = ECStack().back();
   Type *Ty    = I.getOperand(0)->getType();
+
+  /* Pointers are compared as unsigned host words */
+  if (isSmallIntType(Ty) || Ty->isPointerTy()) {
+    auto w = Ty->isPointerTy() ? 64 : Ty->getIntegerBitWidth();
+    auto p = Ty->isPointerTy() ? I.getUnsignedPredicate() : I.getPredicate();
+    auto r = executeSmallICmp(p, getSmallOperandValue(I.getOperand(0), SF),
+                              getSmallOperandValue(I.getOperand(1), SF), w);
+    updateDataDeps(getCurThr().id, &I, I.getOperand(0));
+    updateDataDeps(getCurThr().id, &I, I.getOperand(1));
+    setSmallIntValue(&I, 1, r, SF);
+    return;
+  }
+
   GenericValue Src1 = getOperandValue(I.getOperand(0), SF);
   GenericValue Src2 = getOperandValue(I.getOperand(1), SF);
   GenericValue R;   // Result
@@ -1062,6 +1239,10 @@ static GenericValue executeCmpInst(unsigned predicate, GenericValue Src1,
 void Interpreter::visitBinaryOperator(BinaryOperator &I) {
   ExecutionContext &SF = ECStack().back();
   Type *Ty    = I.getOperand(0)->getType();
+
+  if (executeSmallIntInst(I, SF))
+    return;
+
   GenericValue Src1 = getOperandValue(I.getOperand(0), SF);
   GenericValue Src2 = getOperandValue(I.getOperand(1), SF);
   GenericValue R;   // Result
@@ -1315,7 +1496,7 @@ void Interpreter::visitBranchInst(BranchInst &I) {
   Dest = I.getSuccessor(0);          // Uncond branches have a fixed dest...
   if (!I.isUnconditional()) {
     Value *Cond = I.getCondition();
-    if (getOperandValue(Cond, SF).IntVal == 0) // If false cond...
+    if (getSmallOperandValue(Cond, SF) == 0) // If false cond...
       Dest = I.getSuccessor(1);
     updateCtrlDeps(getCurThr().id, Cond);
   }
@@ -1801,6 +1982,7 @@ void Interpreter::visitCallInstWrapper(CallInstWrapper CS) {
       bool atBegin(Parent->begin() == me);
       if (!atBegin)
         --me;
+      frameSlots.erase(&CS); /* the call is erased; don't let its slot be reused */
       IL->LowerIntrinsicCall(cast<CallInst>(&CS));
 
       // Restore the CurInst pointer to the first instruction newly inserted, if
@@ -1848,6 +2030,9 @@ static unsigned getShiftAmount(uint64_t orgShiftAmount,
 
 void Interpreter::visitShl(BinaryOperator &I) {
   ExecutionContext &SF = ECStack().back();
+  if (executeSmallIntInst(I, SF))
+    return;
+
   GenericValue Src1 = getOperandValue(I.getOperand(0), SF);
   GenericValue Src2 = getOperandValue(I.getOperand(1), SF);
   GenericValue Dest;
@@ -1877,6 +2062,9 @@ void Interpreter::visitShl(BinaryOperator &I) {
 
 void Interpreter::visitLShr(BinaryOperator &I) {
   ExecutionContext &SF = ECStack().back();
+  if (executeSmallIntInst(I, SF))
+    return;
+
   GenericValue Src1 = getOperandValue(I.getOperand(0), SF);
   GenericValue Src2 = getOperandValue(I.getOperand(1), SF);
   GenericValue Dest;
@@ -1906,6 +2094,9 @@ void Interpreter::visitLShr(BinaryOperator &I) {
 
 void Interpreter::visitAShr(BinaryOperator &I) {
   ExecutionContext &SF = ECStack().back();
+  if (executeSmallIntInst(I, SF))
+    return;
+
   GenericValue Src1 = getOperandValue(I.getOperand(0), SF);
   GenericValue Src2 = getOperandValue(I.getOperand(1), SF);
   GenericValue Dest;
@@ -2790,7 +2981,8 @@ GenericValue Interpreter::getOperandValue(Value *V, ExecutionContext &SF) {
   } else if (GlobalValue *GV = dyn_cast<GlobalValue>(V)) {
     return PTOGV(getPointerToGlobal(GV));
   } else {
-    return SF.Values[V];
+    auto slot = getFrameSlot(V);
+    return (slot < SF.Values.size()) ? SF.Values[slot] : GenericValue();
   }
 }
 
@@ -3132,7 +3324,7 @@ void Interpreter::callChannelOpen(Function *F, const std::vector<GenericValue> &
 	Argument *firstArg = &*F->arg_begin();
 	GenericValue firstArgValue = ArgVals[0];
 	int chid = ArgVals[0].IntVal.getLimitedValue();
-	WARN("Channel Open : "+std::to_string(chid) + "\n");
+	driver->visitChannelOpen(chid);
 	return;
 }
 void Interpreter::callChannelSend(Function *F, const std::vector<GenericValue> &ArgVals,
@@ -3143,7 +3335,6 @@ void Interpreter::callChannelSend(Function *F, const std::vector<GenericValue> &
 	int chid = ArgVals[0].IntVal.getLimitedValue();
 	GenericValue secondArgValue = ArgVals[1];
 	int val = ArgVals[1].IntVal.getLimitedValue();
-	// WARN("Channel Send : ch"+std::to_string(chid) +"-> "+std::to_string(val) + "\n");
 	driver->visitSend(SendLabel::create(AtomicOrdering::SequentiallyConsistent, nextPos(),
 						      chid, val), &*specialDeps);
 
@@ -3155,7 +3346,6 @@ void Interpreter::callChannelReceive(Function *F, const std::vector<GenericValue
 	Argument *firstArg = &*F->arg_begin();
 	GenericValue firstArgValue = ArgVals[0];
 	int chid = ArgVals[0].IntVal.getLimitedValue();
-	// WARN("Channel Receive :<- ch"+std::to_string(chid) + "\n");
 	driver->visitReceive(ReceiveLabel::create(AtomicOrdering::SequentiallyConsistent, nextPos(), chid), &*specialDeps);
 	return;
 }
@@ -4640,6 +4830,8 @@ void Interpreter::callFunction(Function *F, const std::vector<GenericValue> &Arg
   // Get pointers to first LLVM BB & Instruction in function.
   StackFrame.CurBB     = &F->front();
   StackFrame.CurInst   = StackFrame.CurBB->begin();
+  StackFrame.Values.resize(frameSizes[F]);
+  StackFrame.Assigned.resize(frameSizes[F]);
 
   // Run through the function arguments and initialize their values...
   assert((ArgVals.size() == F->arg_size() ||
@@ -4656,9 +4848,8 @@ void Interpreter::callFunction(Function *F, const std::vector<GenericValue> &Arg
   StackFrame.VarArgs.assign(ArgVals.begin()+i, ArgVals.end());
 }
 
-std::string getFilenameFromMData(MDNode *node)
+static std::string getFilenameFromMData(const llvm::DILocation &loc)
 {
-	const llvm::DILocation &loc = static_cast<const llvm::DILocation&>(*node);
 	llvm::StringRef file = loc.getFilename();
 	llvm::StringRef dir = loc.getDirectory();
 
@@ -4677,6 +4868,22 @@ std::string getFilenameFromMData(MDNode *node)
 	return absPath;
 }
 
+const std::pair<int, std::string> &Interpreter::getPrefixLOC(int tid, int index)
+{
+	static const std::pair<int, std::string> unknown(0, "");
+
+	auto &locs = getThrById(tid).prefixLOC;
+	if (index < 0 || index >= (int) locs.size() || !locs[index])
+		return unknown;
+
+	auto *loc = locs[index];
+	auto it = locCache.find(loc);
+	if (it == locCache.end())
+		it = locCache.emplace(loc, std::make_pair((int) loc->getLine(),
+							  getFilenameFromMData(*loc))).first;
+	return it->second;
+}
+
 void Interpreter::replayExecutionBefore(const VectorClock &before)
 {
 	reset();
@@ -4706,29 +4913,81 @@ void Interpreter::replayExecutionBefore(const VectorClock &before)
 			if (getCurThr().globalInstructions == snap)
 				continue;
 			/* If there are no metadata for this instruction, skip */
-			if (!I.getMetadata("dbg"))
+			auto *loc = I.getDebugLoc().get();
+			if (!loc)
 				continue;
 
-			/* Store relevant trace information in the appropriate spot */
-			int line = I.getDebugLoc().getLine();
-			std::string file = getFilenameFromMData(I.getMetadata("dbg"));
-			getCurThr().prefixLOC[snap + 1] = std::make_pair(line, file);
-
-			/* If the instruction maps to more than one events, we have to fill more spots */
-			for (auto i = snap + 2; i <= std::min((int) getCurThr().globalInstructions, before[i]); i++)
-				getCurThr().prefixLOC[i] = std::make_pair(line, file);
+			/* Only record the location; it is resolved if it gets printed.
+			 * If the instruction maps to more than one events, we have to fill more spots */
+			for (auto j = snap + 1; j <= std::min((int) getCurThr().globalInstructions, before[i]); j++)
+				getCurThr().prefixLOC[j] = loc;
 		}
 	}
 }
 
+/*
+ * Returns whether I only manipulates the values of its stack frame
+ * (and control flow within its function), i.e., whether executing it
+ * involves neither the driver nor any other thread
+ */
+static bool isLocalInst(const llvm::Instruction &I)
+{
+	switch (I.getOpcode()) {
+#define HANDLE_BINARY_INST(N, OPC, CLASS) case llvm::Instruction::OPC:
+#define HANDLE_UNARY_INST(N, OPC, CLASS) case llvm::Instruction::OPC:
+#define HANDLE_CAST_INST(N, OPC, CLASS) case llvm::Instruction::OPC:
+#include <llvm/IR/Instruction.def>
+	case llvm::Instruction::ICmp:
+	case llvm::Instruction::FCmp:
+	case llvm::Instruction::GetElementPtr:
+	case llvm::Instruction::Select:
+	case llvm::Instruction::Br:
+	case llvm::Instruction::Switch:
+	case llvm::Instruction::ExtractValue:
+	case llvm::Instruction::InsertValue:
+	case llvm::Instruction::ExtractElement:
+	case llvm::Instruction::InsertElement:
+	case llvm::Instruction::ShuffleVector:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void Interpreter::run()
 {
+	auto instructions = 0ull;
+
 	while (driver->scheduleNext()) {
 		driver->handleExecutionInProgress();
 		llvm::ExecutionContext &SF = ECStack().back();
-		llvm::Instruction &I = *SF.CurInst++;
-		visit(I);
+		llvm::Instruction *I = &*SF.CurInst++;
+		auto pos = currPos();
+		visit(*I);
+		++instructions;
+
+		/* A local instruction changes nothing the scheduler looks at,
+		 * so (unless scheduling randomly) the scheduler would pick this
+		 * thread again if its next instruction is local as well, as
+		 * long as the thread can still run and the driver is not
+		 * shutting down (e.g., because another worker found an error) */
+		while (runLocalInstsInline && isLocalInst(*I) &&
+		       isLocalInst(*ECStack().back().CurInst) &&
+		       !getCurThr().isBlocked() && !driver->isHalting()) {
+			I = &*ECStack().back().CurInst++;
+			visit(*I);
+			++instructions;
+		}
+
+		/* Snapshot the thread whenever it crosses an interval */
+		if (checkpointInterval &&
+		    getThrById(pos.thread).globalInstructions / checkpointInterval >
+		    pos.index / checkpointInterval)
+			takeSnapshot(pos.thread);
 	}
+
+	if (Stats::isEnabled())
+		Stats::getLocal().instructions += instructions;
 	return;
 }
 
@@ -4741,6 +5000,8 @@ int Interpreter::runAsMain(const std::string &main)
 	mainECStack = ECStack();
 	setProgramState(llvm::ProgramState::Main);
 	driver->handleExecutionBeginning();
+	if (checkpointInterval)
+		restoreSnapshots();
 	run();
 	driver->handleFinishedExecution();
 	return dynState.ExitValue.IntVal.getZExtValue();
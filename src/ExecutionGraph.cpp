@@ -25,6 +25,7 @@
 #include "MOCalculator.hpp"
 #include "SOCalculator.hpp"
 #include "Parser.hpp"
+#include "TaskPool.hpp"
 #include "WBCalculator.hpp"
 #include "PersistencyChecker.hpp"
 #include <llvm/IR/DebugInfo.h>
@@ -387,15 +388,12 @@ std::vector<Event> ExecutionGraph::getRevisitable(const WriteLabel *sLab) const
 	auto pendingRMW = getPendingRMW(sLab);
 	std::vector<Event> loads;
 
-	for (auto i = 0u; i < getNumThreads(); i++) {
-		for (auto j = before[i] + 1u; j < getThreadSize(i); j++) {
-			const EventLabel *lab = getEventLabel(Event(i, j));
-			if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
-				if (rLab->getAddr() == sLab->getAddr() &&
-				    rLab->isRevisitable() && rLab->wasAddedMax())
-					loads.push_back(rLab->getPos());
-			}
-		}
+	for (auto &r : getReadsFromLoc(sLab->getAddr())) {
+		if (before.contains(r))
+			continue;
+		auto *rLab = getReadLabel(r);
+		if (rLab->isRevisitable() && rLab->wasAddedMax())
+			loads.push_back(r);
 	}
 	if (!pendingRMW.isInitializer())
 		loads.erase(std::remove_if(loads.begin(), loads.end(), [&](Event &e){
@@ -408,19 +406,77 @@ std::vector<Event> ExecutionGraph::getRevisitable(const WriteLabel *sLab) const
 std::vector<Event> ExecutionGraph::getRevisitable(const SendLabel *sLab) const
 {
 	auto &before = getPorfBefore(sLab->getPos());
-	std::vector<Event> loads;
+	auto &chReceives = getReceivesFromCh(sLab->getChannel());
+	std::vector<Event> receives;
 
-	for (auto i = 0u; i < getNumThreads(); i++) {
-		for (auto j = before[i] + 1u; j < getThreadSize(i); j++) {
-			const EventLabel *lab = getEventLabel(Event(i, j));
-			if (auto *rLab = llvm::dyn_cast<ReceiveLabel>(lab)) {
-				if (rLab->getChannel() == sLab->getChannel() &&
-				    rLab->isRevisitable() && rLab->wasAddedMax())
-					loads.push_back(rLab->getPos());
-			}
-		}
+	/* Only receives of this channel are candidates; the index is
+	 * ordered by stamp, so walk it backwards */
+	for (auto it = chReceives.rbegin(); it != chReceives.rend(); ++it) {
+		if (before.contains(*it))
+			continue;
+		auto *rLab = getReceiveLabel(*it);
+		if (rLab->isRevisitable() && rLab->wasAddedMax())
+			receives.push_back(*it);
 	}
-	return loads;
+	return receives;
+}
+
+const std::vector<Event> &ExecutionGraph::getReadsFromLoc(SAddr addr) const
+{
+	static const std::vector<Event> noReads;
+
+	auto it = readsPerLoc.find(addr);
+	return (it != readsPerLoc.end()) ? it->second : noReads;
+}
+
+const std::vector<Event> &ExecutionGraph::getReceivesFromCh(Channel ch) const
+{
+	static const std::vector<Event> noReceives;
+
+	auto it = receivesPerCh.find(ch);
+	return (it != receivesPerCh.end()) ? it->second : noReceives;
+}
+
+void ExecutionGraph::sortReceiveIndex()
+{
+	for (auto &kv : receivesPerCh) {
+		std::sort(kv.second.begin(), kv.second.end(), [&](const Event &a, const Event &b){
+			return getEventLabel(a)->getStamp() < getEventLabel(b)->getStamp();
+		});
+	}
+}
+
+static bool isThreadIndexLess(const Event &a, const Event &b)
+{
+	return a.thread < b.thread || (a.thread == b.thread && a.index < b.index);
+}
+
+void ExecutionGraph::indexLabel(const EventLabel *lab)
+{
+	if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
+		auto &rs = readsPerLoc[rLab->getAddr()];
+		rs.insert(std::lower_bound(rs.begin(), rs.end(), rLab->getPos(), isThreadIndexLess),
+			  rLab->getPos());
+	} else if (auto *rLab = llvm::dyn_cast<ReceiveLabel>(lab)) {
+		/* Fresh receives carry the largest stamp, so the index stays sorted */
+		receivesPerCh[rLab->getChannel()].push_back(rLab->getPos());
+	}
+}
+
+void ExecutionGraph::unindexLabel(const EventLabel *lab)
+{
+	std::vector<Event> *rs = nullptr;
+	if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
+		auto it = readsPerLoc.find(rLab->getAddr());
+		if (it != readsPerLoc.end())
+			rs = &it->second;
+	} else if (auto *rLab = llvm::dyn_cast<ReceiveLabel>(lab)) {
+		auto it = receivesPerCh.find(rLab->getChannel());
+		if (it != receivesPerCh.end())
+			rs = &it->second;
+	}
+	if (rs)
+		rs->erase(std::remove(rs->begin(), rs->end(), lab->getPos()), rs->end());
 }
 
 /* Returns a vector with all reads of a particular location reading from INIT */
@@ -428,10 +484,9 @@ std::vector<Event> ExecutionGraph::getInitRfsAtLoc(SAddr addr) const
 {
 	std::vector<Event> result;
 
-	for (const auto *lab : labels(*this)) {
-		if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab))
-			if (rLab->getRf().isInitializer() && rLab->getAddr() == addr)
-				result.push_back(rLab->getPos());
+	for (auto &r : getReadsFromLoc(addr)) {
+		if (getReadLabel(r)->getRf().isInitializer())
+			result.push_back(r);
 	}
 	return result;
 }
@@ -513,11 +568,15 @@ const EventLabel *ExecutionGraph::addOtherLabelToGraph(std::unique_ptr<EventLabe
 
 	auto pos = lab->getPos();
 	if (pos.index < events[pos.thread].size()) {
+		noteNonAdditiveChange();
+		if (auto *oLab = getEventLabel(pos))
+			unindexLabel(oLab);
 		events[pos.thread][pos.index] = std::move(lab);
 	} else {
 		events[pos.thread].push_back(std::move(lab));
 	}
 	BUG_ON(pos.index > events[pos.thread].size());
+	indexLabel(getEventLabel(pos));
 	WARN_ON_ONCE(pos.index > warnOnGraphSize, "large-graph",
 		     "Graph too large! Are all loops bounded?\n");
 	return getEventLabel(pos);
@@ -551,37 +610,52 @@ void ExecutionGraph::addCalculator(std::unique_ptr<Calculator> cc, RelationId r,
 
 	/* Update indices trackers */
 	calculatorIndex[r] = calcSize;
+	calculatorRelations.push_back(r);
 	relationIndex[r] = relSize;
 }
 
 Calculator::GlobalRelation& ExecutionGraph::getGlobalRelation(RelationId id)
 {
 	BUG_ON(relationIndex.count(id) == 0);
-	return relations.global[relationIndex[id]];
+	return relations.global[relationIndex.at(id)];
+}
+
+Calculator::GlobalRelation& ExecutionGraph::resetGlobalRelation(RelationId id,
+								 Calculator::GlobalRelation &&rel)
+{
+	BUG_ON(relationIndex.count(id) == 0);
+	relations.global.assign(relationIndex.at(id), std::move(rel));
+	return relations.global[relationIndex.at(id)];
+}
+
+const Calculator::GlobalRelation& ExecutionGraph::getHbRelation() const
+{
+	BUG_ON(relationIndex.count(RelationId::hb) == 0);
+	return relations.global[relationIndex.at(RelationId::hb)];
 }
 
 Calculator::PerLocRelation& ExecutionGraph::getPerLocRelation(RelationId id)
 {
 	BUG_ON(relationIndex.count(id) == 0);
-	return relations.perLoc[relationIndex[id]];
+	return relations.perLoc[relationIndex.at(id)];
 }
 
 Calculator::PerLocRelation& ExecutionGraph::getPerChRelation(RelationId id)
 {
 	BUG_ON(relationIndex.count(id) == 0);
-	return relations.perLoc[relationIndex[id]];
+	return relations.perLoc[relationIndex.at(id)];
 }
 
 Calculator::GlobalRelation& ExecutionGraph::getCachedGlobalRelation(RelationId id)
 {
 	BUG_ON(relationIndex.count(id) == 0);
-	return relsCache.global[relationIndex[id]];
+	return relsCache.global[relationIndex.at(id)];
 }
 
 Calculator::PerLocRelation& ExecutionGraph::getCachedPerLocRelation(RelationId id)
 {
 	BUG_ON(relationIndex.count(id) == 0);
-	return relsCache.perLoc[relationIndex[id]];
+	return relsCache.perLoc[relationIndex.at(id)];
 }
 
 void ExecutionGraph::cacheRelations(bool copy /* = true */)
@@ -683,13 +757,13 @@ void ExecutionGraph::addPersistencyChecker(std::unique_ptr<PersistencyChecker> p
 bool ExecutionGraph::isHbBefore(Event a, Event b, CheckConsType t /* = fast */)
 {
 	if (getFPStatus() == FS_Done && getFPType() == t)
-		return getGlobalRelation(ExecutionGraph::RelationId::hb)(a, b);
+		return getHbRelation()(a, b);
 	if (t == CheckConsType::fast)
 		return getEventLabel(b)->getHbView().contains(a);
 
 	/* We have to trigger a calculation */
 	isConsistent(t);
-	return getGlobalRelation(ExecutionGraph::RelationId::hb)(a, b);
+	return getHbRelation()(a, b);
 }
 
 bool isCoMaximalInRel(const Calculator::PerLocRelation &co, SAddr addr, const Event &e)
@@ -758,23 +832,90 @@ bool ExecutionGraph::isRRMaximal(Channel ch, Event e, bool checkCache /* = false
 
 void ExecutionGraph::doInits(bool full /* = false */)
 {
-	auto &hb = relations.global[relationIndex[RelationId::hb]];
-	populateHbEntries(hb);
-	hb.transClosure();
+	/* hb is rebuilt from scratch: do not copy the old one if it is shared */
+	auto hbIdx = relationIndex[RelationId::hb];
+	if (incrementalHb) {
+		/* Drop the previous check's hb first, so that the cache can
+		 * be extended in place, and then share it */
+		relations.global.assign(hbIdx, Calculator::GlobalRelation());
+		updateHbCache();
+		relations.global.share(hbIdx, hbCache);
+	} else {
+		relations.global.assign(hbIdx, Calculator::GlobalRelation());
+		auto &hb = relations.global[hbIdx];
+		populateHbEntries(hb);
+		hb.transClosure();
+	}
+
+	checkedSizes.resize(getNumThreads());
+	for (auto i = 0u; i < getNumThreads(); i++)
+		checkedSizes[i] = getThreadSize(i);
 
 	/* Clear out unused locations */
 	for (auto i = 0u; i < relations.perLoc.size(); i++) {
-		relations.perLoc[i].clear();
-		relsCache.perLoc[i].clear();
+		relations.perLoc.clear(i);
+		relsCache.perLoc.clear(i);
        }
 
+	auto &calcs = consistencyCalculators;
+	std::vector<unsigned int> concurrent, sequential;
+	getCheckCalcs(full, concurrent, sequential);
+
+	std::vector<Stats::Timing> timings(concurrent.size());
+	TaskPool::parallelFor(concurrent.size(), [&](std::size_t i){
+		GENMC_TIME_CALC(Stats::isEnabled() ? &timings[i] : nullptr);
+		calcs[concurrent[i]]->initCalc();
+	});
+	for (auto i = 0u; i < concurrent.size() && Stats::isEnabled(); i++)
+		*getCalcTiming(concurrent[i]) += timings[i];
+
+	for (auto i : sequential) {
+		GENMC_TIME_CALC(getCalcTiming(i));
+		calcs[i]->initCalc();
+	}
+
+	for (auto i : concurrent)
+		calcs[i]->recordStats();
+	for (auto i : sequential)
+		calcs[i]->recordStats();
+	return;
+}
+
+Stats::Timing *ExecutionGraph::getCalcTiming(unsigned int i) const
+{
+	static const std::unordered_map<RelationId, std::string, ENUM_HASH(RelationId) > names = {
+		{RelationId::hb, "hb"}, {RelationId::co, "co"}, {RelationId::lb, "lb"},
+		{RelationId::psc, "psc"}, {RelationId::ar, "ar"}, {RelationId::prop, "prop"},
+		{RelationId::ar_lkmm, "ar_lkmm"}, {RelationId::pb, "pb"},
+		{RelationId::rcu_link, "rcu_link"}, {RelationId::rcu, "rcu"},
+		{RelationId::rcu_fence, "rcu_fence"}, {RelationId::xb, "xb"},
+		{RelationId::mpsc, "mpsc"}, {RelationId::so, "so"}, {RelationId::rr, "rr"},
+	};
+
+	if (!Stats::isEnabled())
+		return nullptr;
+	return &Stats::getLocal().calculators[names.at(calculatorRelations[i])];
+}
+
+void ExecutionGraph::getCheckCalcs(bool full, std::vector<unsigned int> &concurrent,
+				   std::vector<unsigned int> &sequential) const
+{
 	auto &calcs = consistencyCalculators;
 	auto &partial = partialConsCalculators;
 	for (auto i = 0u; i < calcs.size(); i++) {
 		if (!full && std::find(partial.begin(), partial.end(), i) == partial.end())
 			continue;
 
-		calcs[i]->initCalc();
+		/* Only a leading run of independent calculators can go
+		 * first without changing the order the rest observe */
+		if (TaskPool::isEnabled() && sequential.empty() && calcs[i]->isIndependent())
+			concurrent.push_back(i);
+		else
+			sequential.push_back(i);
+	}
+	if (concurrent.size() == 1) {
+		sequential.insert(sequential.begin(), concurrent.back());
+		concurrent.clear();
 	}
 	return;
 }
@@ -784,11 +925,25 @@ Calculator::CalculationResult ExecutionGraph::doCalcs(bool full /* = false */)
 	Calculator::CalculationResult result;
 
 	auto &calcs = consistencyCalculators;
-	auto &partial = partialConsCalculators;
-	for (auto i = 0u; i < calcs.size(); i++) {
-		if (!full && std::find(partial.begin(), partial.end(), i) == partial.end())
-			continue;
+	std::vector<unsigned int> concurrent, sequential;
+	getCheckCalcs(full, concurrent, sequential);
+
+	std::vector<Calculator::CalculationResult> results(concurrent.size());
+	std::vector<Stats::Timing> timings(concurrent.size());
+	TaskPool::parallelFor(concurrent.size(), [&](std::size_t i){
+		GENMC_TIME_CALC(Stats::isEnabled() ? &timings[i] : nullptr);
+		results[i] = calcs[concurrent[i]]->doCalc();
+	});
+	for (auto i = 0u; i < concurrent.size(); i++) {
+		result |= results[i];
+		if (Stats::isEnabled())
+			*getCalcTiming(concurrent[i]) += timings[i];
+	}
+	if (!result.cons)
+		return result;
 
+	for (auto i : sequential) {
+		GENMC_TIME_CALC(getCalcTiming(i));
 		result |= calcs[i]->doCalc();
 
 		/* If an inconsistency was spotted, no reason to call
@@ -837,6 +992,23 @@ bool ExecutionGraph::doFinalConsChecks(bool checkFull /* = false */)
 	if (!hasLB && !hasWB)
 		return true;
 
+	if (!enumerateExtensions) {
+		std::vector<std::pair<RelationId, SAddr> > toExtend;
+		if (hasWB) {
+			for (auto &loc : getPerLocRelation(RelationId::co))
+				toExtend.push_back(std::make_pair(RelationId::co, loc.first));
+		}
+		if (hasLB) {
+			for (auto &loc : getPerLocRelation(RelationId::lb))
+				toExtend.push_back(std::make_pair(RelationId::lb, loc.first));
+		}
+		/* Keep the search order independent of the maps' layout */
+		std::sort(toExtend.begin(), toExtend.end(), [](auto &a, auto &b){
+			return a.first != b.first ? a.first < b.first : a.second < b.second;
+		});
+		return searchConsistentExtension(toExtend);
+	}
+
 	/* Cache all relations because we will need to restore them
 	 * after possible extensions were tried*/
 	cacheRelations();
@@ -892,6 +1064,52 @@ bool ExecutionGraph::doFinalConsChecks(bool checkFull /* = false */)
 	return res;
 }
 
+bool ExecutionGraph::propagateCalcs(bool full /* = false */)
+{
+	FixpointResult res;
+	do {
+		res = doCalcs(full);
+		if (!res.cons)
+			return false;
+	} while (res.changed);
+	return true;
+}
+
+bool ExecutionGraph::searchConsistentExtension(
+	const std::vector<std::pair<RelationId, SAddr> > &toExtend)
+{
+	/* Find a pair of events that is not ordered yet; if there is
+	 * none, all relations are total and the last propagation
+	 * has already established consistency */
+	for (auto &key : toExtend) {
+		auto &rel = getPerLocRelation(key.first)[key.second];
+		for (auto i = 0u; i < rel.size(); i++) {
+			for (auto j = i + 1; j < rel.size(); j++) {
+				if (rel(i, j) || rel(j, i))
+					continue;
+
+				/* Try the order of addition first, as it is more likely */
+				auto &es = rel.getElems();
+				auto a = i, b = j;
+				if (getEventLabel(es[a])->getStamp() > getEventLabel(es[b])->getStamp())
+					std::swap(a, b);
+
+				auto saved = relations;
+				for (auto &e : {std::make_pair(a, b), std::make_pair(b, a)}) {
+					auto &r = getPerLocRelation(key.first)[key.second];
+					if (r.addEdgeAcyclic(e.first, e.second) &&
+					    propagateCalcs(true) &&
+					    searchConsistentExtension(toExtend))
+						return true;
+					relations = saved;
+				}
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 bool ExecutionGraph::isConsistent(CheckConsType checkT)
 {
 	/* Fastpath: We have cached info or no fixpoint is required */
@@ -901,6 +1119,7 @@ bool ExecutionGraph::isConsistent(CheckConsType checkT)
 		return true;
 
 	/* Slowpath: Go calculate fixpoint */
+	GENMC_TIME_PHASE(IsConsistent);
 	setFPStatus(FS_InProgress);
 	doInits(checkT == CheckConsType::full);
 	do {
@@ -955,6 +1174,21 @@ ExecutionGraph::getCoherentRevisits(const WriteLabel *wLab)
 	return getCoherenceCalculator()->getCoherentRevisits(wLab);
 }
 
+std::vector<Event>
+ExecutionGraph::getCoherentRevisits(const SendLabel *sLab)
+{
+	return getSOCalculator()->getCoherentRevisits(sLab);
+}
+
+std::unique_ptr<VectorClock>
+ExecutionGraph::getRevisitView(const BackwardSRRevisit &r) const
+{
+	auto *rLab = getReceiveLabel(r.getPos());
+	auto preds = std::make_unique<View>(getViewFromStamp(rLab->getStamp()));
+	preds->update(getSendLabel(r.getRev())->getPorfView());
+	return std::move(preds);
+}
+
 std::unique_ptr<VectorClock>
 ExecutionGraph::getRevisitView(const BackwardRevisit &r) const
 {
@@ -1006,58 +1240,129 @@ void ExecutionGraph::populatePPoRfEntries(AdjList<Event, EventHasher> &relation)
 	IMPLEMENT_POPULATE_ENTRIES(relation, getPPoRfBefore);
 }
 
+std::vector<Event> ExecutionGraph::getHbEntryPreds(const EventLabel *lab, Event prev) const
+{
+	std::vector<Event> preds;
+
+	if (prev.isInitializer()) {
+		auto *bLab = getEventLabel(Event(lab->getThread(), 0));
+		BUG_ON(!llvm::isa<ThreadStartLabel>(bLab));
+
+		auto parentLast = getPreviousNonTrivial(
+			llvm::dyn_cast<ThreadStartLabel>(bLab)->getParentCreate());
+		if (!parentLast.isInitializer())
+			preds.push_back(parentLast);
+	} else {
+		preds.push_back(prev);
+	}
+	if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
+		if (!rLab->getRf().isInitializer()) {
+			auto &v = rLab->getHbView();
+			auto &predV = getEventLabel(prev)->getHbView();
+			for (auto k = 0u; k < v.size(); k++) {
+				if (k != rLab->getThread() &&
+				    v[k] > 0 &&
+				    !predV.contains(Event(k, v[k]))) {
+					auto cndt = getPreviousNonTrivial(Event(k, v[k]).next());
+					if (cndt.isInitializer())
+						continue;
+					preds.push_back(cndt);
+				}
+			}
+		}
+	}
+	return preds;
+}
+
 void ExecutionGraph::populateHbEntries(AdjList<Event, EventHasher> &relation) const
 {
 	std::vector<Event> elems;
 	std::vector<std::pair<Event, Event> > edges;
 
 	for (auto i = 0u; i < getNumThreads(); i++) {
-		auto thrIdx = elems.size();
+		auto prev = Event::getInitializer();
 		for (auto j = 0u; j < getThreadSize(i); j++) {
 			auto *lab = getEventLabel(Event(i, j));
 			if (!isNonTrivial(lab))
 				continue;
 
-			auto labIdx = elems.size();
-			elems.push_back(Event(i, j));
-
-			if (labIdx == thrIdx) {
-				auto *bLab = getEventLabel(Event(i, 0));
-				BUG_ON(!llvm::isa<ThreadStartLabel>(bLab));
-
-				auto parentLast = getPreviousNonTrivial(
-					llvm::dyn_cast<ThreadStartLabel>(bLab)->getParentCreate());
-				if (!parentLast.isInitializer())
-					edges.push_back(std::make_pair(parentLast, elems[labIdx]));
-			}
-			if (labIdx > thrIdx)
-				edges.push_back(std::make_pair(elems[labIdx - 1], elems[labIdx]));
-			if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
-				if (!rLab->getRf().isInitializer()) {
-					auto pred = (labIdx > thrIdx) ?
-						elems[labIdx - 1] : Event::getInitializer();
-					auto &v = rLab->getHbView();
-					auto &predV = getEventLabel(pred)->getHbView();
-					for (auto k = 0u; k < v.size(); k++) {
-						if (k != rLab->getThread() &&
-						    v[k] > 0 &&
-						    !predV.contains(Event(k, v[k]))) {
-							auto cndt = getPreviousNonTrivial(Event(k, v[k]).next());
-							if (cndt.isInitializer())
-								continue;
-							edges.push_back(std::make_pair(cndt, rLab->getPos()));
-						}
-					}
-				}
-			}
+			elems.push_back(lab->getPos());
+			for (auto &p : getHbEntryPreds(lab, prev))
+				edges.push_back(std::make_pair(p, lab->getPos()));
+			prev = lab->getPos();
 		}
 	}
-	relation = AdjList<Event, EventHasher>(std::move(elems));
+	relation = AdjList<Event, EventHasher>(std::move(elems), getRelationBackend(RelationId::hb));
 	for (auto &e : edges)
 		relation.addEdge(e.first, e.second);
 	return;
 }
 
+bool ExecutionGraph::extendHbCache()
+{
+	std::vector<const EventLabel *> added;
+
+	for (auto i = 0u; i < getNumThreads(); i++) {
+		auto from = (i < hbCacheSizes.size()) ? hbCacheSizes[i] : 0;
+		for (auto j = from; j < getThreadSize(i); j++) {
+			auto *lab = getEventLabel(Event(i, j));
+			if (isNonTrivial(lab))
+				added.push_back(lab);
+		}
+	}
+	std::sort(added.begin(), added.end(), [](const EventLabel *a, const EventLabel *b){
+		return a->getStamp() < b->getStamp();
+	});
+
+	/* Predecessors have smaller stamps, unless the graph was restamped */
+	hbCacheLast.resize(getNumThreads(), Event::getInitializer());
+	for (auto *lab : added) {
+		auto preds = getHbEntryPreds(lab, hbCacheLast[lab->getThread()]);
+		if (std::any_of(preds.begin(), preds.end(), [&](const Event &p){
+					return !hbCache->contains(p);
+				}))
+			return false;
+		hbCache->addSinkNode(lab->getPos(), preds);
+		hbCacheLast[lab->getThread()] = lab->getPos();
+	}
+
+	hbCacheSizes.resize(getNumThreads());
+	for (auto i = 0u; i < getNumThreads(); i++)
+		hbCacheSizes[i] = getThreadSize(i);
+	return true;
+}
+
+void ExecutionGraph::updateHbCache()
+{
+	if (hbCacheValid) {
+		/* Copy the cache if some relation (e.g., a cached one) still
+		 * shares it; otherwise, synchronize with the release of the
+		 * last other owner, as CowVector does */
+		if (hbCache.use_count() > 1)
+			hbCache = std::make_shared<Calculator::GlobalRelation>(*hbCache);
+		else
+			std::atomic_thread_fence(std::memory_order_acquire);
+		if (extendHbCache()) {
+			GENMC_COUNT_INCREMENTAL("hbCacheExtended");
+			return;
+		}
+	}
+	GENMC_COUNT_INCREMENTAL("hbCacheRebuilt");
+
+	hbCache = std::make_shared<Calculator::GlobalRelation>();
+	populateHbEntries(*hbCache);
+	hbCache->transClosure();
+
+	hbCacheSizes.resize(getNumThreads());
+	hbCacheLast.resize(getNumThreads());
+	for (auto i = 0u; i < getNumThreads(); i++) {
+		hbCacheSizes[i] = getThreadSize(i);
+		hbCacheLast[i] = getPreviousNonTrivial(Event(i, getThreadSize(i)));
+	}
+	hbCacheValid = true;
+	return;
+}
+
 
 /************************************************************
  ** Calculation of particular sets of events/event labels
@@ -1130,10 +1435,20 @@ ExecutionGraph::saveCoherenceStatus(const std::vector<std::unique_ptr<EventLabel
 void ExecutionGraph::remove(const EventLabel *lab)
 {
 	setFPStatus(FS_Stale);
+	noteNonAdditiveChange();
 	if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
 		if (auto *wLab = llvm::dyn_cast<WriteLabel>(getEventLabel(rLab->getRf())))
 			wLab->removeReader([&](const Event &r){ return r == rLab->getPos(); });
 	}
+	if (auto *rLab = llvm::dyn_cast<ReceiveLabel>(lab)) {
+		if (!rLab->getRf().isBottom()) {
+			auto *sLab = llvm::dyn_cast<SendLabel>(getEventLabel(rLab->getRf()));
+			if (sLab && sLab->getReader() == rLab->getPos())
+				sLab->removeReader();
+		}
+	}
+	for (auto j = lab->getIndex(); j < (int) getThreadSize(lab->getThread()); j++)
+		unindexLabel(getEventLabel(Event(lab->getThread(), j)));
 	if (lab != getLastThreadLabel(lab->getThread()))
 		addOtherLabelToGraph(EmptyLabel::create(lab->getPos()));
 	BUG_ON(lab->getIndex() >= getThreadSize(lab->getThread()));
@@ -1292,11 +1607,32 @@ bool ExecutionGraph::hasBeenRevisitedByDeleted(const BackwardRevisit &r,
 		(!hasBAM() || !llvm::isa<BIncFaiWriteLabel>(getEventLabel(rfLab->getPos())));
 }
 
+bool ExecutionGraph::hasBeenRevisitedByDeleted(const BackwardSRRevisit &r,
+					       const EventLabel *eLab) const
+{
+	Event rf = Event::getBottom();
+	if (auto *rLab = llvm::dyn_cast<ReadLabel>(eLab))
+		rf = rLab->getRf();
+	else if (auto *rLab = llvm::dyn_cast<ReceiveLabel>(eLab))
+		rf = rLab->getRf();
+	if (rf.isBottom())
+		return false;
+
+	auto *rfLab = getEventLabel(rf);
+	auto v = getRevisitView(r);
+	return !v->contains(rfLab->getPos()) && rfLab->getStamp() > eLab->getStamp();
+}
+
 bool ExecutionGraph::isMaximalExtension(const BackwardRevisit &r) const
 {
 	return getCoherenceCalculator()->inMaximalPath(r);
 }
 
+bool ExecutionGraph::isMaximalExtension(const BackwardSRRevisit &r) const
+{
+	return getSOCalculator()->inMaximalPath(r);
+}
+
 bool ExecutionGraph::revisitModifiesGraph(const BackwardRevisit &r) const
 {
 	auto v = getRevisitView(r);
@@ -1316,6 +1652,9 @@ bool ExecutionGraph::revisitModifiesGraph(const BackwardRevisit &r) const
 void ExecutionGraph::changeRf(Event read, Event store)
 {
 	setFPStatus(FS_Stale);
+	/* New reads get their rf after being added: that only adds edges */
+	if (isCoveredByLastCheck(read))
+		noteNonAdditiveChange();
 	/* First, we set the new reads-from edge */
 	ReadLabel *rLab = llvm::dyn_cast<ReadLabel>(getEventLabel(read));
 	BUG_ON(!rLab);
@@ -1349,6 +1688,8 @@ void ExecutionGraph::changeRf(Event read, Event store)
 void ExecutionGraph::changeRf(Channel ch, Event receive, Event send)
 {
 	setFPStatus(FS_Stale);
+	if (isCoveredByLastCheck(receive))
+		noteNonAdditiveChange();
 	/* First, we set the new reads-from edge */
 	ReceiveLabel *rLab = llvm::dyn_cast<ReceiveLabel>(getEventLabel(receive));
 	BUG_ON(!rLab);
@@ -1457,6 +1798,7 @@ DepView ExecutionGraph::getDepViewFromStamp(unsigned int stamp) const
 void ExecutionGraph::changeStoreOffset(SAddr addr, Event s, int newOffset)
 {
 	setFPStatus(FS_Stale);
+	noteNonAdditiveChange();
 
 	if (auto *cohTracker = llvm::dyn_cast<MOCalculator>(getCoherenceCalculator()))
 		cohTracker->changeStoreOffset(addr, s, newOffset);
@@ -1465,14 +1807,26 @@ void ExecutionGraph::changeStoreOffset(SAddr addr, Event s, int newOffset)
 void ExecutionGraph::changeSendOffset(Channel ch, Event s, int newOffset)
 {
 	setFPStatus(FS_Stale);
+	noteNonAdditiveChange();
 
 	if (auto *soTracker = getSOCalculator())
 		soTracker->changeSendOffset(ch, s, newOffset);
 }
 
+void ExecutionGraph::compressStampsAfter(unsigned int st)
+{
+	resetStamp(st + 1);
+	for (auto *lab : labels(*this)) {
+		if (lab->getStamp() > st)
+			lab->setStamp(nextStamp());
+	}
+	sortReceiveIndex();
+}
+
 void ExecutionGraph::cutToStamp(unsigned int stamp)
 {
 	setFPStatus(FS_Stale);
+	noteNonAdditiveChange();
 	auto preds = getViewFromStamp(stamp);
 
 	/* Inform all calculators about the events cutted */
@@ -1485,6 +1839,18 @@ void ExecutionGraph::cutToStamp(unsigned int stamp)
 		auto &thr = events[i];
 		thr.erase(thr.begin() + preds[i] + 1, thr.end());
 	}
+	for (auto &kv : readsPerLoc) {
+		auto &rs = kv.second;
+		rs.erase(std::remove_if(rs.begin(), rs.end(), [&](const Event &r){
+			return !preds.contains(r);
+		}), rs.end());
+	}
+	for (auto &kv : receivesPerCh) {
+		auto &rs = kv.second;
+		rs.erase(std::remove_if(rs.begin(), rs.end(), [&](const Event &r){
+			return !preds.contains(r);
+		}), rs.end());
+	}
 
 	/* Remove any 'pointers' to events that have been removed */
 	for (auto i = 0u; i < getNumThreads(); i++) {
@@ -1502,6 +1868,10 @@ void ExecutionGraph::cutToStamp(unsigned int stamp)
 				wLab->removeReader([&](Event r){
 						return !preds.contains(r);
 					});
+			} else if (auto *sLab = llvm::dyn_cast<SendLabel>(lab)) {
+				if (!sLab->getReader().isBottom() &&
+				    !preds.contains(sLab->getReader()))
+					sLab->removeReader();
 			}
 			/* No special action for CreateLabels; we can
 			 * keep the begin event of the child the since
@@ -1528,6 +1898,7 @@ void ExecutionGraph::copyGraphUpTo(ExecutionGraph &other, const VectorClock &v)
 	other.partialConsCalculators = partialConsCalculators;
 
 	other.calculatorIndex = calculatorIndex;
+	other.calculatorRelations = calculatorRelations;
 	other.relationIndex = relationIndex;
 
 	if (persChecker.get())
@@ -1535,6 +1906,9 @@ void ExecutionGraph::copyGraphUpTo(ExecutionGraph &other, const VectorClock &v)
 	other.recoveryTID = recoveryTID;
 
 	other.bam = bam;
+	other.denseRelations = denseRelations;
+	other.enumerateExtensions = enumerateExtensions;
+	other.incrementalHb = incrementalHb;
 
 	/* Then, copy the appropriate events */
 	/* FIXME: Fix LAPOR (use addLockLabelToGraphLAPOR??) */
@@ -1559,8 +1933,14 @@ void ExecutionGraph::copyGraphUpTo(ExecutionGraph &other, const VectorClock &v)
 					return !v.contains(r);
 				});
 			}
+			if (auto *sLab = llvm::dyn_cast<SendLabel>(nLab)) {
+				if (!sLab->getReader().isBottom() && !v.contains(sLab->getReader()))
+					const_cast<SendLabel *>(sLab)->removeReader();
+			}
 			if (auto *mLab = llvm::dyn_cast<MemAccessLabel>(nLab))
 				occ->trackCoherenceAtLoc(mLab->getAddr());
+			if (auto *cLab = llvm::dyn_cast<ChannelAccessLabel>(nLab))
+				other.trackSendOrderAtCh(cLab->getChannel());
 			if (auto *tcLab = llvm::dyn_cast<ThreadCreateLabel>(nLab))
 				;
 			if (auto *eLab = llvm::dyn_cast<ThreadFinishLabel>(nLab))
@@ -1569,6 +1949,7 @@ void ExecutionGraph::copyGraphUpTo(ExecutionGraph &other, const VectorClock &v)
 				other.getLbCalculatorLAPOR()->addLockToList(lLab->getLockAddr(), lLab->getPos());
 		}
 	}
+	other.sortReceiveIndex();
 
 	/* Finally, copy coherence info */
 	/* FIXME: Temporary ugly hack */
@@ -1579,6 +1960,18 @@ void ExecutionGraph::copyGraphUpTo(ExecutionGraph &other, const VectorClock &v)
 			}
 		}
 	}
+
+	/* ... and send-order info, if it is tracked */
+	if (hasCalculator(RelationId::so)) {
+		auto *soc = getSOCalculator();
+		auto *osoc = other.getSOCalculator();
+		for (auto it = soc->begin(); it != soc->end(); ++it) {
+			for (auto sIt = it->second.begin(); sIt != it->second.end(); ++sIt) {
+				if (v.contains(*sIt))
+					osoc->addSendToCh(it->first, *sIt, -1);
+			}
+		}
+	}
 	/* FIXME: Make sure all fields are copied */
 	return;
 }
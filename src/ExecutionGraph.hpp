@@ -24,6 +24,7 @@
 #include "config.h"
 #include "AdjList.hpp"
 #include "CoherenceCalculator.hpp"
+#include "CowVector.hpp"
 #include "SOCalculator.hpp"
 #include "DriverGraphEnumAPI.hpp"
 #include "DepInfo.hpp"
@@ -31,11 +32,13 @@
 #include "Event.hpp"
 #include "EventLabel.hpp"
 #include "Revisit.hpp"
+#include "Stats.hpp"
 #include "VectorClock.hpp"
 #include <llvm/ADT/StringMap.h>
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 
 class CoherenceCalculator;
 class LBCalculatorLAPOR;
@@ -70,8 +73,9 @@ private:
 
 		Relations() = default;
 
-		std::vector<Calculator::GlobalRelation> global;
-		std::vector<Calculator::PerLocRelation> perLoc;
+		/* Copies share the relations until one of them writes */
+		CowVector<Calculator::GlobalRelation> global;
+		CowVector<Calculator::PerLocRelation> perLoc;
 
 		FixpointStatus fixStatus;
 		FixpointResult fixResult;
@@ -158,6 +162,19 @@ public:
 	/* Resets the next available stamp to the specified value */
 	void resetStamp(unsigned int val) { timestamp = val; }
 
+	/* Returns the largest stamp that has been handed out */
+	unsigned int getMaxStamp() const { return timestamp - 1; }
+
+	/* Returns the number of modifications other than the addition of
+	 * events so far. Information derived from the graph only
+	 * needs to be recalculated for the added events if this is
+	 * unchanged since the derivation */
+	unsigned int getNonAdditiveChanges() const { return nonAdditiveChanges; }
+
+	/* Renumbers all labels with stamps larger than ST so that their
+	 * stamps immediately follow ST (in thread order) */
+	void compressStampsAfter(unsigned int st);
+
 	/* Event addition methods should be called from the managing objects,
 	 * so that the relation managing objects are also informed */
 	const ReadLabel *addReadLabelToGraph(std::unique_ptr<ReadLabel> lab,
@@ -368,12 +385,23 @@ public:
 	virtual std::unique_ptr<VectorClock>
 	getRevisitView(const BackwardRevisit &r) const;
 
+	/* Same as above, for a revisit of a receive by a send */
+	std::unique_ptr<VectorClock>
+	getRevisitView(const BackwardSRRevisit &r) const;
+
 	/* Returns a list of loads that can be revisited */
 	virtual std::vector<Event> getRevisitable(const WriteLabel *sLab) const;
 
-	/* Returns a list of receivers that can be revisited */
+	/* Returns a list of receivers that can be revisited,
+	 * in reverse order of addition */
 	virtual std::vector<Event> getRevisitable(const SendLabel *sLab) const;
 
+	/* Returns all reads from ADDR, ordered by thread and index */
+	const std::vector<Event> &getReadsFromLoc(SAddr addr) const;
+
+	/* Returns all receives from channel CH, ordered by stamp */
+	const std::vector<Event> &getReceivesFromCh(Channel ch) const;
+
 	/* Returns the first po-predecessor satisfying F */
 	template <typename F>
 	const EventLabel *getPreviousLabelST(const EventLabel *lab, F&& cond) const {
@@ -415,13 +443,29 @@ public:
 	Calculator::PerLocRelation& getPerLocRelation(RelationId id);
 	Calculator::PerLocRelation& getPerChRelation(RelationId id);
 
+	/* Returns hb for reading. Unlike getGlobalRelation(), this does not
+	 * detach hb from the hb cache it shares its storage with */
+	const Calculator::GlobalRelation& getHbRelation() const;
+
+	/* Replaces the specified relation matrix with REL (without copying
+	 * the old one if it is shared), and returns a reference to it */
+	Calculator::GlobalRelation& resetGlobalRelation(RelationId id,
+							Calculator::GlobalRelation &&rel);
+
+	/* Returns the backend the specified (global) relation should be built with */
+	Calculator::GlobalRelation::Backend getRelationBackend(RelationId id) const {
+		return denseRelations.count(id) ? Calculator::GlobalRelation::Backend::dense :
+						  Calculator::GlobalRelation::Backend::sparse;
+	}
+
 	/* Returns a reference to the cached version of the
 	 * specified relation matrix */
 	Calculator::GlobalRelation& getCachedGlobalRelation(RelationId id);
 	Calculator::PerLocRelation& getCachedPerLocRelation(RelationId id);
 
-	/* Caches all calculated relations. If "copy" is true then a
-	 * copy of each relation is cached */
+	/* Caches all calculated relations. If "copy" is true then the
+	 * cache shares each relation with the graph, and a relation is
+	 * only copied once either side writes to it */
 	void cacheRelations(bool copy = true);
 
 	/* Restores all relations to their most recently cached versions.
@@ -578,6 +622,7 @@ public:
 	/* Returns true if ELAB has been revisited by some event that
 	 * will be deleted by the revisit R */
 	bool hasBeenRevisitedByDeleted(const BackwardRevisit &r, const EventLabel *eLab) const;
+	bool hasBeenRevisitedByDeleted(const BackwardSRRevisit &r, const EventLabel *eLab) const;
 
 	/* Returns whether the prefix of SLAB contains LAB's matching lock */
 	bool prefixContainsMatchingLock(const BackwardRevisit &r, const EventLabel *lab) const {
@@ -596,6 +641,7 @@ public:
 	/* Returns true if all events to be removed by the revisit
 	 * RLAB <- SLAB form a maximal extension */
 	bool isMaximalExtension(const BackwardRevisit &r) const;
+	bool isMaximalExtension(const BackwardSRRevisit &r) const;
 
 	/* Returns true if the graph that will be created when sLab revisits rLab
 	 * will be the same as the current one */
@@ -621,6 +667,7 @@ public:
 	std::pair<int, int> getCoherentPlacings(SAddr addr, Event pos, bool isRMW);
 	std::pair<int, int> getCoherentPlacings(Channel ch, Event pos);
 	std::vector<Event> getCoherentRevisits(const WriteLabel *wLab);
+	std::vector<Event> getCoherentRevisits(const SendLabel *sLab);
 
 
 	/* Graph modification methods */
@@ -685,6 +732,32 @@ public:
 protected:
 	void enableBAM() { bam = true; }
 
+	/* Makes the specified relation use the dense backend */
+	void useDenseRelation(RelationId id) { denseRelations.insert(id); }
+
+	/* Makes full checks enumerate all extensions of co/lb rather
+	 * than searching for a consistent one (for benchmarking) */
+	void enableExtensionEnumeration() { enumerateExtensions = true; }
+
+	/* Makes hb be maintained across consistency checks */
+	void enableIncrementalHb() { incrementalHb = true; }
+
+	/* Records a modification of the graph other than the addition of
+	 * events (e.g., a cut or an rf change), which invalidates any
+	 * information carried over from previous consistency checks */
+	void noteNonAdditiveChange() {
+		hbCacheValid = false;
+		++nonAdditiveChanges;
+	}
+
+	/* Whether E was already in the graph at the last consistency check.
+	 * Information carried over from the checks does not depend on the
+	 * rf of a read that was not */
+	bool isCoveredByLastCheck(Event e) const {
+		return e.thread < (int) checkedSizes.size() &&
+			e.index < (int) checkedSizes[e.thread];
+	}
+
 	void resizeThread(unsigned int tid, unsigned int size) {
 		events[tid].resize(size);
 	};
@@ -700,6 +773,11 @@ protected:
 
 	void copyGraphUpTo(ExecutionGraph &other, const VectorClock &v) const;
 
+	/* Adds/removes LAB to/from the per-location read index
+	 * or the per-channel receive index, as appropriate */
+	void indexLabel(const EventLabel *lab);
+	void unindexLabel(const EventLabel *lab);
+
 	FixpointStatus getFPStatus() const { return relations.fixStatus; }
 	void setFPStatus(FixpointStatus s) { relations.fixStatus = s; }
 
@@ -711,6 +789,14 @@ protected:
 
 	void doInits(bool fullCalc = false);
 
+	/* Splits (the indices of) the calculators taking part in a check into
+	 * the ones that can run concurrently (first) and the ones that run in order */
+	void getCheckCalcs(bool full, std::vector<unsigned int> &concurrent,
+			   std::vector<unsigned int> &sequential) const;
+
+	/* Returns where the time of calculator I should be accounted (-stats) */
+	Stats::Timing *getCalcTiming(unsigned int i) const;
+
 	/* Performs a step of all the specified calculations. Takes as
 	 * a parameter whether a full calculation needs to be performed */
 	FixpointResult doCalcs(bool fullCalc = false);
@@ -719,13 +805,45 @@ protected:
 	 * and returns the final decision re. consistency */
 	bool doFinalConsChecks(bool checkFull = false);
 
+	/* Runs the specified calculations until a fixpoint is reached.
+	 * Returns false if an inconsistency is found along the way */
+	bool propagateCalcs(bool fullCalc = false);
+
+	/* Full checks: Extends the per-location relations in TOEXTEND to
+	 * total orders, one edge at a time, propagating the consequences
+	 * of each edge and backtracking on conflicts. Returns true if a
+	 * consistent extension exists, leaving it in the relations */
+	bool searchConsistentExtension(
+		const std::vector<std::pair<RelationId, SAddr> > &toExtend);
+
 private:
+	/* Restores the stamp order of the per-channel receive index */
+	void sortReceiveIndex();
+
+	/* Returns the immediate hb-predecessors of the non-trivial LAB,
+	 * given the last non-trivial event PREV before it in its thread */
+	std::vector<Event> getHbEntryPreds(const EventLabel *lab, Event prev) const;
+
+	/* Brings the cached hb up to date with the graph, extending it
+	 * with the events added since the last check if possible */
+	void updateHbCache();
+
+	/* Adds the events past the cached prefix to the cached hb, in
+	 * stamp order. Returns false if the cache could not be extended */
+	bool extendHbCache();
+
 	/* A collection of threads and the events for each threads */
 	ThreadList events;
 
 	/* The next available timestamp */
 	unsigned int timestamp;
 
+	/* The reads of each location, ordered by thread and index */
+	std::unordered_map<SAddr, std::vector<Event> > readsPerLoc;
+
+	/* The receives of each channel, ordered by stamp */
+	std::unordered_map<Channel, std::vector<Event> > receivesPerCh;
+
 	/* Relations and calculation status/result */
 	Relations relations;
 	Relations relsCache;
@@ -741,6 +859,9 @@ private:
 	/* Keeps track of calculator indices */
 	std::unordered_map<RelationId, unsigned int, ENUM_HASH(RelationId) > calculatorIndex;
 
+	/* The relation each calculator computes (by calculator index) */
+	std::vector<RelationId> calculatorRelations;
+
 	/* Keeps track of relation indices. Note that an index might
 	 * refer to either relations.global or relations.perLoc */
 	std::unordered_map<RelationId, unsigned int, ENUM_HASH(RelationId) > relationIndex;
@@ -756,6 +877,32 @@ private:
 	/* BAM: Flag indicating how we should treat barrier operations */
 	bool bam = false;
 
+	/* The relations built with the dense backend */
+	std::unordered_set<RelationId, ENUM_HASH(RelationId) > denseRelations;
+
+	/* Whether full checks enumerate all extensions of co/lb */
+	bool enumerateExtensions = false;
+
+	/* The number of modifications other than the addition of events */
+	unsigned int nonAdditiveChanges = 0;
+
+	/* The size of each thread at the last consistency check */
+	std::vector<unsigned int> checkedSizes;
+
+	/* Whether hb is maintained incrementally across checks */
+	bool incrementalHb = false;
+
+	/* The hb relation as calculated from the graph alone (i.e.,
+	 * without any edges added by the calculators), along with the
+	 * prefix of each thread it covers and the last non-trivial event
+	 * of each such prefix. The cache is only ever extended; anything
+	 * other than the addition of events invalidates it. hb shares the
+	 * cache's storage until a calculator writes to it */
+	bool hbCacheValid = false;
+	std::shared_ptr<Calculator::GlobalRelation> hbCache;
+	std::vector<unsigned int> hbCacheSizes;
+	std::vector<Event> hbCacheLast;
+
 	/* Dbg: Size of graphs which triggers a warning */
 	unsigned int warnOnGraphSize = UINT_MAX;
 };
@@ -29,6 +29,7 @@
 #include "LabelVisitor.hpp"
 #include "Parser.hpp"
 #include "SExprVisitor.hpp"
+#include "TaskPool.hpp"
 #include "ThreadPool.hpp"
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/DynamicLibrary.h>
@@ -37,6 +38,7 @@
 
 #include <algorithm>
 #include <csignal>
+#include <mutex>
 
 /************************************************************
  ** GENERIC MODEL CHECKING DRIVER
@@ -45,7 +47,7 @@
 GenMCDriver::GenMCDriver(std::shared_ptr<const Config> conf, std::unique_ptr<llvm::Module> mod,
 			 std::unique_ptr<ModuleInfo> MI)
 	: userConf(conf), result(), isMootExecution(false), readToReschedule(Event::getInitializer()),
-	  shouldHalt(false)
+	  trace(conf->traceSize), shouldHalt(false)
 {
 	std::string buf;
 
@@ -58,7 +60,10 @@ GenMCDriver::GenMCDriver(std::shared_ptr<const Config> conf, std::unique_ptr<llv
 		.withCoherenceType(userConf->coherence)
 		.withEnabledLAPOR(userConf->LAPOR)
 		.withEnabledPersevere(userConf->persevere, userConf->blockSize)
-		.withEnabledBAM(!userConf->disableBAM).build();
+		.withEnabledBAM(!userConf->disableBAM)
+		.withIncrementalHb(!userConf->disableIncrementalCons && !userConf->LAPOR)
+		.withExtensionEnumeration(userConf->enumerateExtensions)
+		.withDenseRelations(userConf->denseRelations).build();
 
 	/* Set up a random-number generator (for the scheduler) */
 	std::random_device rd;
@@ -85,16 +90,18 @@ GenMCDriver::LocalState::~LocalState() = default;
 
 GenMCDriver::LocalState::LocalState(std::unique_ptr<ExecutionGraph> g, RevisitSetT &&r, LocalQueueT &&w,
 				    std::unique_ptr<llvm::EELocalState> interpState, bool isMootExecution,
-				    Event readToReschedule, const std::vector<Event> &threadPrios)
+				    Event readToReschedule, const std::vector<Event> &threadPrios,
+				    unsigned int splitDepth)
 	: graph(std::move(g)), revset(std::move(r)), workqueue(std::move(w)),
 	  interpState(std::move(interpState)), isMootExecution(isMootExecution),
-	  readToReschedule(readToReschedule), threadPrios(threadPrios) {}
+	  readToReschedule(readToReschedule), threadPrios(threadPrios), splitDepth(splitDepth) {}
 
 std::unique_ptr<GenMCDriver::LocalState> GenMCDriver::releaseLocalState()
 {
 	return std::make_unique<GenMCDriver::LocalState>(
 		std::move(execGraph), std::move(revisitSet), std::move(workqueue),
-		getEE()->releaseLocalState(), isMootExecution, readToReschedule, threadPrios);
+		getEE()->releaseLocalState(), isMootExecution, readToReschedule, threadPrios,
+		splitDepth);
 }
 
 void GenMCDriver::restoreLocalState(std::unique_ptr<GenMCDriver::LocalState> state)
@@ -106,6 +113,7 @@ void GenMCDriver::restoreLocalState(std::unique_ptr<GenMCDriver::LocalState> sta
 	isMootExecution = state->isMootExecution;
 	readToReschedule = state->readToReschedule;
 	threadPrios = std::move(state->threadPrios);
+	splitDepth = state->splitDepth;
 	return;
 }
 
@@ -117,14 +125,17 @@ GenMCDriver::SharedState::SharedState(std::unique_ptr<ExecutionGraph> g,
 
 std::unique_ptr<GenMCDriver::SharedState> GenMCDriver::getSharedState()
 {
-	return std::make_unique<GenMCDriver::SharedState>(
+	auto state = std::make_unique<GenMCDriver::SharedState>(
 		std::move(execGraph), getEE()->getSharedState());
+	state->depth = splitDepth;
+	return state;
 }
 
 void GenMCDriver::setSharedState(std::unique_ptr<GenMCDriver::SharedState> state)
 {
 	execGraph = std::move(state->graph);
 	getEE()->setSharedState(std::move(state->interpState));
+	splitDepth = state->depth;
 	return;
 }
 
@@ -451,6 +462,14 @@ bool GenMCDriver::isExecutionBlocked() const
 
 void GenMCDriver::handleFinishedExecution()
 {
+	if (Stats::isEnabled()) {
+		const auto &g = getGraph();
+		auto size = 0u;
+		for (auto i = 0u; i < g.getNumThreads(); i++)
+			size += g.getThreadSize(i);
+		Stats::recordGraph(size, LabelAllocator::getBytesInUse() + View::getHeapBytesInUse());
+	}
+
 	/* LAPOR: Check lock-well-formedness */
 	if (getConf()->LAPOR && !isLockWellFormedLAPOR())
 		WARN_ONCE("lapor-not-well-formed", "Execution not lock-well-formed!\n");
@@ -478,6 +497,10 @@ void GenMCDriver::handleFinishedExecution()
 		return;
 	if (getConf()->printExecGraphs && !getConf()->persevere)
 		printGraph(); /* Delay printing if persevere is enabled */
+	if (getConf()->printMemStats) {
+		result.labelBytes += LabelAllocator::getBytesInUse() + View::getHeapBytesInUse();
+		result.labelCount += LabelAllocator::getBlocksInUse();
+	}
 	++result.explored;
 	return;
 }
@@ -531,6 +554,19 @@ void GenMCDriver::run()
 {
 	/* Explore all graphs and print the results */
 	explore();
+	if (getConf()->printChannelStats) {
+		for (auto &kv : SOCalculator::takeChannelStats())
+			result.channelStats[kv.first] += kv.second;
+	}
+	if (Stats::isEnabled())
+		result.stats += Stats::takeLocal();
+
+	/* If no error was reported, print the trace on its own */
+	if (trace.isEnabled() && result.status == Status::VS_OK) {
+		static std::mutex traceMutex;
+		std::lock_guard<std::mutex> lock(traceMutex);
+		trace.print(llvm::dbgs());
+	}
 	return;
 }
 
@@ -559,22 +595,33 @@ GenMCDriver::Result GenMCDriver::verify(std::shared_ptr<const Config> conf, std:
 	if (conf->transformFile != "")
 		LLVMModule::printLLVMModule(*mod, conf->transformFile);
 
+	if (conf->printStats || conf->statsFile != "")
+		Stats::enable();
+	if (conf->printChannelStats)
+		SOCalculator::enableChannelStats();
+
+	/* Helpers for the consistency checks (the callers count as one) */
+	if (conf->consThreads > 1)
+		TaskPool::start(conf->consThreads - 1);
+
 	if (conf->threads == 1) {
 		auto driver = DriverFactory::create(conf, std::move(mod), std::move(MI));
 		driver->run();
 		return driver->getResult();
 	}
 
-	std::vector<std::future<GenMCDriver::Result>> futures;
+	GenMCDriver::Result res;
 	{
 		/* Then, fire up the drivers */
 		ThreadPool tp(conf, mod, MI);
-		futures = tp.waitForTasks();
-	}
+		auto futures = tp.waitForTasks();
+		for (auto &f : futures)
+			res += f.get();
 
-	GenMCDriver::Result res;
-	for (auto &f : futures)
-		res += f.get();
+		/* All workers are done with their statistics at this point */
+		if (conf->printPoolStats)
+			tp.printWorkerStats(llvm::outs());
+	}
 	return res;
 }
 
@@ -653,14 +700,39 @@ void GenMCDriver::notifyEERemoved(const VectorClock &v)
 
 void GenMCDriver::restrictGraph(const EventLabel *rLab)
 {
+	GENMC_TIME_PHASE(RestrictGraph);
+
 	/* Inform the interpreter about deleted events, and then
 	 * restrict the graph (and relations) */
 	notifyEERemoved(*getGraph().getPredsView(rLab->getPos()));
 	getGraph().cutToStamp(rLab->getStamp());
 	getGraph().resetStamp(rLab->getStamp() + 1);
+	pruneCheckpoints();
 	return;
 }
 
+void GenMCDriver::invalidateCheckpoints(Event e)
+{
+	getEE()->dropSnapshots(e.thread, e.index);
+}
+
+void GenMCDriver::pruneCheckpoints()
+{
+	const auto &g = getGraph();
+	auto *EE = getEE();
+
+	/* A snapshot after the k-th event of a thread is valid as long
+	 * as the first k events remain (unchanged) in the graph */
+	for (auto i = 0u; i < EE->getSnapshots().size(); i++)
+		EE->dropSnapshots(i, i < g.getNumThreads() ? g.getThreadSize(i) : 0);
+}
+
+void GenMCDriver::inheritCheckpoints(const LocalState &state)
+{
+	getEE()->setSnapshots(state.interpState->snapshots);
+	pruneCheckpoints();
+}
+
 
 /************************************************************
  ** Scheduling methods
@@ -694,6 +766,7 @@ bool GenMCDriver::rescheduleReads()
 		BUG_ON(!pLab);
 
 		setRescheduledRead(pLab->getPos());
+		invalidateCheckpoints(pLab->getPos());
 		g.remove(bLab);
 		g.remove(pLab);
 
@@ -735,9 +808,12 @@ void GenMCDriver::explore()
 		EE->reset();
 
 		/* Get main program function and run the program */
-		EE->runAsMain(getConf()->programEntryFun);
-		if (getConf()->persevere)
-			EE->runRecovery();
+		{
+			GENMC_TIME_EXECUTION();
+			EE->runAsMain(getConf()->programEntryFun);
+			if (getConf()->persevere)
+				EE->runRecovery();
+		}
 
 		auto validExecution = true;
 		do {
@@ -1683,6 +1759,7 @@ void GenMCDriver::checkReconsiderFaiSpinloop(const MemAccessLabel *lab)
 		if (!isHbBefore(lab->getPos(), faiLab->getPos())) {
 			if (getEE()->getThrById(eLab->getThread()).globalInstructions != 0)
 				--getEE()->getThrById(eLab->getThread()).globalInstructions;
+			invalidateCheckpoints(eLab->getPos());
 			g.remove(eLab->getPos());
 			thr.unblock();
 		}
@@ -1692,6 +1769,7 @@ void GenMCDriver::checkReconsiderFaiSpinloop(const MemAccessLabel *lab)
 
 std::vector<Event> GenMCDriver::getRfsApproximation(const ReadLabel *lab)
 {
+	GENMC_TIME_PHASE(GetRfsApproximation);
 	auto rfs = getGraph().getCoherentStores(lab->getAddr(), lab->getPos());
 	if (!llvm::isa<CasReadLabel>(lab) && !llvm::isa<FaiReadLabel>(lab))
 		return rfs;
@@ -1715,6 +1793,7 @@ std::vector<Event> GenMCDriver::getRfsApproximation(const ReadLabel *lab)
 
 std::vector<Event> GenMCDriver::getRfsApproximation(const ReceiveLabel *lab)
 {
+	GENMC_TIME_PHASE(GetRfsApproximation);
 	auto rfs = getGraph().getCoherentSends(lab->getChannel(), lab->getPos());
 	return rfs;
 }
@@ -1832,14 +1911,15 @@ void GenMCDriver::filterOptimizeRfs(const ReadLabel *lab, std::vector<Event> &st
 
 int GenMCDriver::visitReceive(std::unique_ptr<ReceiveLabel> rLab, const EventDeps *deps)
 {
-	WARN("Channel Receive :<- ch"+std::to_string(rLab->getChannel()) + "\n");
 	auto &g = getGraph();
 	auto *EE = getEE();
 	auto &thr = EE->getCurThr();
 
 	if (isExecutionDrivenByGraph()){
 		/* Check whether we should block the thread due to not-enabled receive*/
-		if (rLab->getRf().isBottom()) {
+		auto *gLab = llvm::dyn_cast<ReceiveLabel>(g.getEventLabel(rLab->getPos()));
+		BUG_ON(!gLab);
+		if (gLab->getRf().isBottom()) {
 			BUG_ON(!inReplay());
 			thr.block(BlockageType::NotEnabledReceive);
 		}
@@ -1865,9 +1945,12 @@ int GenMCDriver::visitReceive(std::unique_ptr<ReceiveLabel> rLab, const EventDep
 		/*If all rfs are inconsistent- we need to block this thread
 		due to NotEnabledReceive*/
 		BUG_ON(!inReplay());
+		GENMC_TRACE(trace, TraceBuffer::Kind::Block, lab->getPos(), -1, 0, Event::getInitializer(),
+			    static_cast<std::uint8_t>(BlockageType::NotEnabledReceive));
 		thr.block(BlockageType::NotEnabledReceive);
 		return 0;
 	}
+	GENMC_TRACE(trace, TraceBuffer::Kind::Receive, lab->getPos(), lab->getChannel(), 0, lab->getRf());
 
 	// GENMC_DEBUG(
 	// 	if (getConf()->vLevel >= VerbosityLevel::V3) {
@@ -1890,13 +1973,27 @@ int GenMCDriver::visitReceive(std::unique_ptr<ReceiveLabel> rLab, const EventDep
 	return 0;
 }
 
+void GenMCDriver::visitChannelOpen(int chid)
+{
+	const auto &g = getGraph();
+	auto next = getEE()->nextPos();
+
+	/* Opens add no events (so we cannot use isExecutionDrivenByGraph(),
+	 * which advances the position): only trace them outside replays */
+	if (next.index < g.getThreadSize(next.thread) &&
+	    !llvm::isa<EmptyLabel>(g.getEventLabel(next)))
+		return;
+
+	GENMC_TRACE(trace, TraceBuffer::Kind::ChannelOpen, getEE()->currPos(), chid);
+}
+
 void GenMCDriver::visitSend(std::unique_ptr<SendLabel> sLab, const EventDeps *deps)
 {
-	WARN("Channel Send : ch"+std::to_string(sLab->getChannel()) +"-> "+std::to_string(sLab->getVal()) 
-			+ " ("+std::to_string(sLab->getPos().thread) +","+std::to_string(sLab->getPos().index)+")\n");
 	if (isExecutionDrivenByGraph())
 		return;
 
+	GENMC_TRACE(trace, TraceBuffer::Kind::Send, sLab->getPos(), sLab->getChannel(), sLab->getVal());
+
 	auto &g = getGraph();
 	auto *EE = getEE();
 
@@ -1930,6 +2027,8 @@ void GenMCDriver::visitSend(std::unique_ptr<SendLabel> sLab, const EventDeps *de
 	if (!isConsistent(ProgramPoint::step)) {
 		/*Check if thread should be blocked due to notenabled send
 		in case of boundedChannel-TODO*/
+		GENMC_TRACE(trace, TraceBuffer::Kind::Block, lab->getPos(), -1, 0, Event::getInitializer(),
+			    static_cast<std::uint8_t>(BlockageType::Cons));
 		getEE()->block(BlockageType::Cons);
 		cons = false;
 	}
@@ -2075,6 +2174,13 @@ std::vector<Event> GenMCDriver::getRevisitableApproximation(const WriteLabel *sL
 	return loads;
 }
 
+std::vector<Event> GenMCDriver::getRevisitableApproximation(const SendLabel *sLab)
+{
+	auto &g = getGraph();
+	/* Already in reverse-stamp order (see getRevisitable()) */
+	return g.getCoherentRevisits(sLab);
+}
+
 void GenMCDriver::visitStore(std::unique_ptr<WriteLabel> wLab, const EventDeps *deps)
 {
 	if (isExecutionDrivenByGraph())
@@ -2425,7 +2531,10 @@ void GenMCDriver::visitError(Event pos, Status s, const std::string &err /* = ""
 	 * destroy the current execution stack */
 	auto oldState = getEE()->releaseLocalState();
 
-	getEE()->replayExecutionBefore(getReplayView());
+	{
+		GENMC_TIME_PHASE(Replay);
+		getEE()->replayExecutionBefore(getReplayView());
+	}
 
 	llvm::raw_string_ostream out(result.message);
 
@@ -2447,6 +2556,9 @@ void GenMCDriver::visitError(Event pos, Status s, const std::string &err /* = ""
 	if (!err.empty())
 		out << err << "\n";
 
+	/* Print what led the exploration here, if traced */
+	trace.print(out);
+
 	/* Dump the graph into a file (DOT format) */
 	if (getConf()->dotFile != "")
 		dotPrintToFile(getConf()->dotFile, errLab->getPos(), confEvent);
@@ -2502,6 +2614,7 @@ bool GenMCDriver::tryOptimizeBarrierRevisits(const BIncFaiWriteLabel *sLab, std:
 		auto *rLab = llvm::dyn_cast<BWaitReadLabel>(g.getEventLabel(l));
 		changeRf(rLab->getPos(), sLab->getPos());
 		rLab->setAddedMax(isCoMaximal(rLab->getAddr(), rLab->getRf()));
+		invalidateCheckpoints(g.getLastThreadEvent(l.thread));
 		g.remove(g.getLastThreadLabel(l.thread));
 		if (getEE()->getThrById(rLab->getThread()).globalInstructions != 0)
 			--getEE()->getThrById(rLab->getThread()).globalInstructions;
@@ -2629,6 +2742,7 @@ bool GenMCDriver::tryRevisitLockInPlace(const BackwardRevisit &r)
 
 	BUG_ON(!llvm::isa<LockCasReadLabel>(rLab) || !llvm::isa<UnlockWriteLabel>(sLab));
 	BUG_ON(!llvm::isa<BlockLabel>(g.getEventLabel(rLab->getPos().next())));
+	invalidateCheckpoints(rLab->getPos().next());
 	g.remove(rLab->getPos().next());
 	changeRf(rLab->getPos(), sLab->getPos());
 	rLab->setAddedMax(isCoMaximal(rLab->getAddr(), rLab->getRf()));
@@ -2674,8 +2788,6 @@ GenMCDriver::constructBackwardRevisit(const ReadLabel *rLab, const WriteLabel *s
 std::unique_ptr<ExecutionGraph>
 GenMCDriver::copyGraph(const BackwardRevisit *br, VectorClock *v) const
 {
-	auto &g = getGraph();
-
 	/* Adjust the view that will be used for copying */
 	if (auto *brh = llvm::dyn_cast<BackwardRevisitHELPER>(br)) {
 		if (auto *dv = llvm::dyn_cast<DepView>(v)) {
@@ -2686,22 +2798,37 @@ GenMCDriver::copyGraph(const BackwardRevisit *br, VectorClock *v) const
 			--(*v)[brh->getMid().thread];
 		}
 	}
+	return copyGraphUpTo(br->getPos(), br->getRev(), *v);
+}
+
+std::unique_ptr<ExecutionGraph>
+GenMCDriver::copyGraph(const BackwardSRRevisit *br, VectorClock *v) const
+{
+	return copyGraphUpTo(br->getPos(), br->getRev(), *v);
+}
 
-	auto og = g.getCopyUpTo(*v);
+std::unique_ptr<ExecutionGraph>
+GenMCDriver::copyGraphUpTo(Event revisited, Event revisitor, const VectorClock &v) const
+{
+	GENMC_TIME_PHASE(CopyGraph);
+	auto &g = getGraph();
+	auto og = g.getCopyUpTo(v);
 
 	/* Adjust stamps in the copy, and ensure the prefix of the
-	 * write will not be revisitable */
-	auto *revLab = og->getReadLabel(br->getPos());
-	auto &prefix = og->getPrefixView(br->getRev());
-	og->resetStamp(revLab->getStamp() + 1);
+	 * revisitor will not be revisitable */
+	auto *revLab = og->getEventLabel(revisited);
+	auto &prefix = og->getPrefixView(revisitor);
+	og->compressStampsAfter(revLab->getStamp());
 
 	for (auto *lab : labels(*og)) {
 		if (auto *rLab = llvm::dyn_cast<ReadLabel>(lab)) {
-			if (rLab && prefix.contains(rLab->getPos()))
+			if (prefix.contains(rLab->getPos()))
+				rLab->setRevisitStatus(false);
+		}
+		if (auto *rLab = llvm::dyn_cast<ReceiveLabel>(lab)) {
+			if (prefix.contains(rLab->getPos()))
 				rLab->setRevisitStatus(false);
 		}
-		if (lab->getStamp() > revLab->getStamp())
-			lab->setStamp(og->nextStamp());
 	}
 	return og;
 }
@@ -2727,6 +2854,7 @@ bool GenMCDriver::checkRevBlockHELPER(const WriteLabel *sLab, const std::vector<
 
 bool GenMCDriver::calcRevisits(const WriteLabel *sLab)
 {
+	GENMC_TIME_PHASE(CalcRevisits);
 	auto &g = getGraph();
 
 	auto loads = getRevisitableApproximation(sLab);
@@ -2750,142 +2878,79 @@ bool GenMCDriver::calcRevisits(const WriteLabel *sLab)
 
 		GENMC_DEBUG(checkForDuplicateRevisit(rLab, sLab););
 
+		auto copyStart = std::chrono::steady_clock::now();
 		auto v = g.getRevisitView(*br);
 		auto og = copyGraph(&*br, &*v);
 		auto read = rLab->getPos();
 		auto write = sLab->getPos(); /* prefetch since we are gonna change state */
+		auto span = g.getMaxStamp() - rLab->getStamp();
 
 		auto localState = releaseLocalState();
 		auto newState = std::make_unique<SharedState>(std::move(og), getEE()->getSharedState());
+		auto copyTime = std::chrono::steady_clock::now() - copyStart;
+		newState->depth = splitDepth + 1;
 
 		setSharedState(std::move(newState));
+		inheritCheckpoints(*localState);
 
 		notifyEERemoved(*v);
 		revisitRead(BackwardRevisit(read, write));
-
-		/* If there are idle workers in the thread pool,
-		 * try submitting the job instead */
-		auto *tp = getThreadPool();
-		if (tp && tp->getRemainingTasks() < 8 * tp->size()) {
-			tp->submit(getSharedState());
-		} else {
-			if (isConsistent(ProgramPoint::step))
-				explore();
-		}
+		exploreOrSubmitRevisit(span, copyTime);
 
 		restoreLocalState(std::move(localState));
 	}
 
 	return checkAtomicity(sLab) && checkRevBlockHELPER(sLab, loads) && !isMoot();
 }
-//TODO
 bool GenMCDriver::calcRevisits(const SendLabel *sLab)
 {
+	GENMC_TIME_PHASE(CalcRevisits);
 	auto &g = getGraph();
 
-	// auto loads = getRevisitableApproximation(sLab);
-	// if (tryOptimizeRevisits(sLab, loads))
-	// 	return true;
-
-	// for (auto &l : loads) {
-	// 	auto *rLab = g.getReadLabel(l);
-	// 	BUG_ON(!rLab);
-
-	// 	auto br = constructBackwardRevisit(rLab, sLab);
-	// 	if (!g.isMaximalExtension(*br))
-	// 		break;
-
-	// 	/* Optimize handling of lock operations */
-	// 	if (llvm::isa<LockCasReadLabel>(rLab) && llvm::isa<UnlockWriteLabel>(sLab)) {
-	// 		if (tryRevisitLockInPlace(*br))
-	// 			break;
-	// 		moot();
-	// 	}
-
-	// 	GENMC_DEBUG(checkForDuplicateRevisit(rLab, sLab););
+	auto receives = getRevisitableApproximation(sLab);
+	for (auto &r : receives) {
+		auto *rLab = g.getReceiveLabel(r);
+		BUG_ON(!rLab);
 
-	// 	auto v = g.getRevisitView(*br);
-	// 	auto og = copyGraph(&*br, &*v);
-	// 	auto read = rLab->getPos();
-	// 	auto write = sLab->getPos(); /* prefetch since we are gonna change state */
+		BackwardSRRevisit br(rLab, sLab);
+		if (!g.isMaximalExtension(br))
+			break;
 
-	// 	auto localState = releaseLocalState();
-	// 	auto newState = std::make_unique<SharedState>(std::move(og), getEE()->getSharedState());
+		auto copyStart = std::chrono::steady_clock::now();
+		auto v = g.getRevisitView(br);
+		auto og = copyGraph(&br, &*v);
+		auto span = g.getMaxStamp() - rLab->getStamp();
 
-	// 	setSharedState(std::move(newState));
+		auto localState = releaseLocalState();
+		auto newState = std::make_unique<SharedState>(std::move(og), getEE()->getSharedState());
+		auto copyTime = std::chrono::steady_clock::now() - copyStart;
+		newState->depth = splitDepth + 1;
 
-	// 	notifyEERemoved(*v);
-	// 	revisitRead(BackwardRevisit(read, write));
+		setSharedState(std::move(newState));
+		inheritCheckpoints(*localState);
 
-	// 	/* If there are idle workers in the thread pool,
-	// 	 * try submitting the job instead */
-	// 	auto *tp = getThreadPool();
-	// 	if (tp && tp->getRemainingTasks() < 8 * tp->size()) {
-	// 		tp->submit(getSharedState());
-	// 	} else {
-	// 		if (isConsistent(ProgramPoint::step))
-	// 			explore();
-	// 	}
+		notifyEERemoved(*v);
+		revisitReceive(br);
+		exploreOrSubmitRevisit(span, copyTime);
 
-	// 	restoreLocalState(std::move(localState));
-	// }
+		restoreLocalState(std::move(localState));
+	}
 
-	return  !isMoot();
+	return !isMoot();
 }
 
-//TODO
-bool GenMCDriver::calcRevisits(const ReceiveLabel *sLab)
+void GenMCDriver::exploreOrSubmitRevisit(unsigned int span, std::chrono::nanoseconds copyTime)
 {
-	auto &g = getGraph();
-
-	// auto loads = getRevisitableApproximation(sLab);
-	// if (tryOptimizeRevisits(sLab, loads))
-	// 	return true;
-
-	// for (auto &l : loads) {
-	// 	auto *rLab = g.getReadLabel(l);
-	// 	BUG_ON(!rLab);
-
-	// 	auto br = constructBackwardRevisit(rLab, sLab);
-	// 	if (!g.isMaximalExtension(*br))
-	// 		break;
-
-	// 	/* Optimize handling of lock operations */
-	// 	if (llvm::isa<LockCasReadLabel>(rLab) && llvm::isa<UnlockWriteLabel>(sLab)) {
-	// 		if (tryRevisitLockInPlace(*br))
-	// 			break;
-	// 		moot();
-	// 	}
-
-	// 	GENMC_DEBUG(checkForDuplicateRevisit(rLab, sLab););
-
-	// 	auto v = g.getRevisitView(*br);
-	// 	auto og = copyGraph(&*br, &*v);
-	// 	auto read = rLab->getPos();
-	// 	auto write = sLab->getPos(); /* prefetch since we are gonna change state */
-
-	// 	auto localState = releaseLocalState();
-	// 	auto newState = std::make_unique<SharedState>(std::move(og), getEE()->getSharedState());
-
-	// 	setSharedState(std::move(newState));
-
-	// 	notifyEERemoved(*v);
-	// 	revisitRead(BackwardRevisit(read, write));
-
-	// 	/* If there are idle workers in the thread pool,
-	// 	 * try submitting the job instead */
-	// 	auto *tp = getThreadPool();
-	// 	if (tp && tp->getRemainingTasks() < 8 * tp->size()) {
-	// 		tp->submit(getSharedState());
-	// 	} else {
-	// 		if (isConsistent(ProgramPoint::step))
-	// 			explore();
-	// 	}
-
-	// 	restoreLocalState(std::move(localState));
-	// }
-
-	return  !isMoot();
+	/* If the pool can use more work, try submitting the job instead */
+	auto *tp = getThreadPool();
+	if (tp && tp->shouldSplit(splitDepth, span, copyTime)) {
+		auto task = getSharedState();
+		task->span = span;
+		tp->submit(std::move(task));
+	} else {
+		if (isConsistent(ProgramPoint::step))
+			explore();
+	}
 }
 
 void GenMCDriver::repairLock(LockCasReadLabel *lab)
@@ -3058,10 +3123,18 @@ bool GenMCDriver::revisitReceive(const ReceiveRevisit &ri)
 	auto *rLab = llvm::dyn_cast<ReceiveLabel>(g.getEventLabel(ri.getPos()));
 	BUG_ON(!rLab);
 
-	changeRf(rLab->getPos(), ri.getRev());
+	changeRf(rLab->getChannel(), rLab->getPos(), ri.getRev());
 	auto *fri = llvm::dyn_cast<ForwardRecvRevisit>(&ri);
-	//TODO - rr maximal
-	rLab->setAddedMax(isRRMaximal(rLab->getChannel(), ri.getRev()));
+	rLab->setAddedMax(fri ? fri->isMaximal() : isRRMaximal(rLab->getChannel(), ri.getRev()));
+
+	GENMC_DEBUG(
+		if (getConf()->vLevel >= VerbosityLevel::V2) {
+			llvm::dbgs() << "--- " << (llvm::isa<BackwardSRRevisit>(ri) ? "Backward" : "Forward")
+			<< " revisiting " << ri.getPos()
+			<< " <-- " << ri.getRev() << "\n";
+			printGraph();
+		}
+	);
 	return true;
 }
 
@@ -3072,6 +3145,10 @@ bool GenMCDriver::restrictAndRevisit(WorkSet::ItemT item)
 	auto *EE = getEE();
 	EventLabel *lab = g.getEventLabel(item->getPos());
 
+	GENMC_COUNT_REVISIT(item->getKind());
+	GENMC_TRACE(trace, TraceBuffer::Kind::Revisit, item->getPos(), -1, 0, Event::getInitializer(),
+		    static_cast<std::uint8_t>(item->getKind()));
+
 	/* First, appropriately restrict the worklist, the revisit set, and the graph */
 	restrictWorklist(lab);
 	restrictRevisitSet(lab);
@@ -3098,6 +3175,7 @@ bool GenMCDriver::restrictAndRevisit(WorkSet::ItemT item)
 		auto *oLab = llvm::dyn_cast<OptionalLabel>(lab);
 		--result.exploredBlocked;
 		BUG_ON(!oLab);
+		invalidateCheckpoints(oLab->getPos());
 		oLab->setExpandable(false);
 		oLab->setExpanded(true);
 		return true;
@@ -3561,8 +3639,10 @@ void GenMCDriver::printGraph(bool printMetadata /* false */, llvm::raw_ostream &
 				if (getConf()->vLevel >= VerbosityLevel::V1)
 					s << " @ " << lab->getStamp();
 			);
-			if (printMetadata && thr.prefixLOC[j].first && shouldPrintLOC(lab)) {
-				executeMDPrint(lab, thr.prefixLOC[j], getConf()->inputFile, s);
+			if (printMetadata && shouldPrintLOC(lab)) {
+				auto &loc = EE->getPrefixLOC(i, j);
+				if (loc.first)
+					executeMDPrint(lab, loc, getConf()->inputFile, s);
 			}
 			s << "\n";
 		}
@@ -3646,9 +3726,10 @@ void GenMCDriver::dotPrintToFile(const std::string &filename,
 			ss << printer.toString(*lab);
 
 			/* And then, print the corresponding line number */
-			if (thr.prefixLOC[j].first && shouldPrintLOC(lab)) {
+			auto &loc = EE->getPrefixLOC(i, j);
+			if (loc.first && shouldPrintLOC(lab)) {
 				ss << " <FONT COLOR=\"gray\">";
-				executeMDPrint(lab, thr.prefixLOC[j], getConf()->inputFile, ss);
+				executeMDPrint(lab, loc, getConf()->inputFile, ss);
 				ss << "</FONT>";
 			}
 
@@ -3725,7 +3806,8 @@ void GenMCDriver::recPrintTraceBefore(const Event &e, View &a,
 		 * (it is the store of the PID) */
 		if (i > 0 && llvm::isa<ThreadCreateLabel>(g.getPreviousLabel(lab)))
 			continue;
-		Parser::parseInstFromMData(thr.prefixLOC[i], thr.threadFun->getName().str(), ss);
+		Parser::parseInstFromMData(getEE()->getPrefixLOC(e.thread, i),
+					   thr.threadFun->getName().str(), ss);
 	}
 	return;
 }
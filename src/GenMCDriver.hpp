@@ -25,9 +25,13 @@
 #include "DepInfo.hpp"
 #include "EventLabel.hpp"
 #include "RevisitSet.hpp"
+#include "SOCalculator.hpp"
+#include "Stats.hpp"
+#include "Trace.hpp"
 #include "WorkSet.hpp"
 #include <llvm/IR/Module.h>
 
+#include <chrono>
 #include <ctime>
 #include <map>
 #include <memory>
@@ -86,12 +90,17 @@ public:
 		unsigned explored;        /* Number of complete executions explored */
 		unsigned exploredBlocked; /* Number of blocked executions explored */
 		unsigned exploredMoot;
+		long long labelBytes;     /* Label memory sampled at complete executions */
+		long long labelCount;     /* Labels alive at the sampling points */
+		SOCalculator::ChannelStatsMap channelStats; /* Send-order check paths per channel */
+		Stats::Data stats;        /* Profiling counters (-stats) */
 #ifdef ENABLE_GENMC_DEBUG
 		unsigned duplicates;      /* Number of duplicate executions explored */
 #endif
 		std::string message;      /* A message to be printed */
 
 		Result() : status(Status::VS_OK), explored(0), exploredBlocked(0), exploredMoot(0),
+			   labelBytes(0), labelCount(0), channelStats(), stats(),
 #ifdef ENABLE_GENMC_DEBUG
 			   duplicates(0),
 #endif
@@ -106,6 +115,11 @@ public:
 			explored += other.explored;
 			exploredBlocked += other.exploredBlocked;
 			exploredMoot += other.exploredMoot;
+			labelBytes += other.labelBytes;
+			labelCount += other.labelCount;
+			for (auto &kv : other.channelStats)
+				channelStats[kv.first] += kv.second;
+			stats += other.stats;
 #ifdef ENABLE_GENMC_DEBUG
 			duplicates += other.duplicates;
 #endif
@@ -122,13 +136,14 @@ public:
 		bool isMootExecution;
 		Event readToReschedule;
 		std::vector<Event> threadPrios;
+		unsigned int splitDepth;
 
 		/* FIXME: Ensure that move semantics work properly for std::unordered_map<> */
 		LocalState() = delete;
 		LocalState(std::unique_ptr<ExecutionGraph> g, RevisitSetT &&r,
 			   LocalQueueT &&w, std::unique_ptr<llvm::EELocalState> state,
 			   bool isMootExecution, Event readToReschedule,
-			   const std::vector<Event> &threadPrios);
+			   const std::vector<Event> &threadPrios, unsigned int splitDepth);
 
 		~LocalState();
 	};
@@ -136,6 +151,12 @@ public:
 		std::unique_ptr<ExecutionGraph> graph;
 		std::unique_ptr<llvm::EESharedState> interpState;
 
+		/* Number of backward revisits that led to this state */
+		unsigned int depth = 0;
+
+		/* Number of stamps that were dropped when this state was created */
+		unsigned int span = 0;
+
 		/* FIXME: Ensure that move semantics work properly for std::unordered_map<> */
 		SharedState() = delete;
 		SharedState(std::unique_ptr<ExecutionGraph> g,
@@ -185,6 +206,9 @@ public:
 	/* Stops the verification procedure when an error is found */
 	void halt(Status status);
 
+	/* Returns true if this driver is shutting down */
+	bool isHalting() const;
+
 	/* Returns the result of the verification procedure */
 	Result getResult() const { return result; }
 
@@ -199,6 +223,7 @@ public:
 	/*** Instruction-related actions ***/
 
 	void visitChOpen(std::unique_ptr<SendLabel> sLab, const EventDeps *deps);
+	void visitChannelOpen(int chid);
 	void visitSend(std::unique_ptr<SendLabel> sLab, const EventDeps *deps);
 	int visitReceive(std::unique_ptr<ReceiveLabel> rLab, const EventDeps *deps);
 
@@ -387,6 +412,10 @@ protected:
 	bool isRRMaximal(Channel addr, Event e, bool checkCache = false,
 				ProgramPoint p = ProgramPoint::step);
 
+	/* Checkpointing: Drops the interpreter snapshots that cover E,
+	 * as E is being changed or removed */
+	void invalidateCheckpoints(Event e);
+
 private:
 	/*** Worklist-related ***/
 
@@ -421,9 +450,6 @@ private:
 	 * Exhaustively explores all  consistent executions of a program */
 	void explore();
 
-	/* Returns true if this driver is shutting down */
-	bool isHalting() const;
-
 	/* Returns true if this execution is moot */
 	bool isMoot() const { return isMootExecution; }
 
@@ -552,7 +578,10 @@ private:
 	 * Returns true if the current exploration should continue */
 	bool calcRevisits(const WriteLabel *lab);
 	bool calcRevisits(const SendLabel *lab);
-	bool calcRevisits(const ReceiveLabel *lab);
+
+	/* Explores the state resulting from a backward revisit that dropped
+	 * SPAN stamps, or submits it to the pool if that is deemed better */
+	void exploreOrSubmitRevisit(unsigned int span, std::chrono::nanoseconds copyTime);
 
 	/* Modifies (but not restricts) the graph when we are revisiting a read.
 	 * Returns true if the resulting graph should be explored. */
@@ -578,10 +607,25 @@ private:
 	/* Removes all labels with stamp >= st from the graph */
 	void restrictGraph(const EventLabel *lab);
 
+	/* Checkpointing: Drops the interpreter snapshots that cover
+	 * events no longer in the graph */
+	void pruneCheckpoints();
+
+	/* Checkpointing: Keeps the snapshots of STATE that remain valid
+	 * for the (restricted) graph of a backward revisit */
+	void inheritCheckpoints(const LocalState &state);
+
 	/* Copies the current EG according to BR's view V.
 	 * May modify V but will not execute BR in the copy. */
 	std::unique_ptr<ExecutionGraph>
 	copyGraph(const BackwardRevisit *br, VectorClock *v) const;
+	std::unique_ptr<ExecutionGraph>
+	copyGraph(const BackwardSRRevisit *br, VectorClock *v) const;
+
+	/* Helper for copyGraph(): copies the current EG up to V, and makes
+	 * the prefix of REVISITOR, which revisits REVISITED, non-revisitable */
+	std::unique_ptr<ExecutionGraph>
+	copyGraphUpTo(Event revisited, Event revisitor, const VectorClock &v) const;
 
 	/* Given a list of stores that it is consistent to read-from,
 	 * filters out options that can be skipped (according to the conf),
@@ -749,6 +793,10 @@ private:
 	 * The reads are ordered in reverse-addition order */
 	virtual std::vector<Event> getRevisitableApproximation(const WriteLabel *sLab);
 
+	/* Returns an approximation of the receives that SLAB can revisit.
+	 * The receives are ordered in reverse-addition order */
+	virtual std::vector<Event> getRevisitableApproximation(const SendLabel *sLab);
+
 	/* Changes the reads-from edge for the specified label.
 	 * This effectively changes the label, hence this method is virtual */
 	virtual void changeRf(Event read, Event store) = 0;
@@ -806,9 +854,16 @@ private:
 	/* Opt: Whether a particular read needs to be repaired during rescheduling */
 	Event readToReschedule;
 
+	/* Number of backward revisits that led to the current state
+	 * (used to decide whether to hand revisits to the pool) */
+	unsigned int splitDepth = 0;
+
 	/* Verification result to be returned to caller */
 	Result result;
 
+	/* Dbg: The most recent channel operations, revisits and blockings */
+	TraceBuffer trace;
+
 	/* Whether we are stopping the exploration (e.g., due to an error found) */
 	bool shouldHalt;
 
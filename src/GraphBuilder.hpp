@@ -97,6 +97,36 @@ public:
 		return *this;
 	}
 
+	GraphBuilder &withDenseRelations(const std::vector<std::string> &names) {
+		using RelationId = ExecutionGraph::RelationId;
+		static const std::unordered_map<std::string, RelationId> ids = {
+			{"hb", RelationId::hb},
+			{"psc", RelationId::psc}, {"ar", RelationId::ar},
+			{"prop", RelationId::prop}, {"ar_lkmm", RelationId::ar_lkmm},
+			{"pb", RelationId::pb}, {"rcu_link", RelationId::rcu_link},
+			{"rcu", RelationId::rcu}, {"rcu_fence", RelationId::rcu_fence},
+			{"xb", RelationId::xb}, {"mpsc", RelationId::mpsc},
+		};
+		/* The names have been validated by the config */
+		for (auto &n : names) {
+			BUG_ON(!ids.count(n));
+			graph->useDenseRelation(ids.at(n));
+		}
+		return *this;
+	}
+
+	GraphBuilder &withExtensionEnumeration(bool enumerate) {
+		if (enumerate)
+			graph->enableExtensionEnumeration();
+		return *this;
+	}
+
+	GraphBuilder &withIncrementalHb(bool incremental) {
+		if (incremental)
+			graph->enableIncrementalHb();
+		return *this;
+	}
+
 	std::unique_ptr<ExecutionGraph> build() {
 		BUG_ON(!graph->getCoherenceCalculator());
 		return std::move(graph);
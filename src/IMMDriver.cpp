@@ -333,6 +333,7 @@ void IMMDriver::calcLockLAPORViews(LockLabelLAPOR *lab, const EventDeps *deps)
 
 void IMMDriver::updateLabelViews(EventLabel *lab, const EventDeps *deps)
 {
+	GENMC_TIME_PHASE(UpdateLabelViews);
 	const auto &g = getGraph();
 
 	switch (lab->getKind()) {
@@ -428,6 +429,7 @@ void IMMDriver::changeRf(Event read, Event store)
 	auto &g = getGraph();
 
 	/* Change the reads-from relation in the graph */
+	invalidateCheckpoints(read);
 	g.changeRf(read, store);
 
 	/* And update the views of the load */
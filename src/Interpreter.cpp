@@ -43,8 +43,10 @@
 #include "Interpreter.h"
 #include <llvm/CodeGen/IntrinsicLowering.h>
 #include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Module.h>
 #include <cstring>
+#include <limits>
 
 using namespace llvm;
 
@@ -112,6 +114,56 @@ void Interpreter::reset()
 	std::for_each(threads_begin(), threads_end(), [this](Thread &thr){ resetThread(thr.id); });
 }
 
+void Interpreter::takeSnapshot(int tid)
+{
+	auto &thr = getThrById(tid);
+
+	/* Only snapshot threads that will resume normally */
+	if (thr.ECStack.empty() || thr.isBlocked() ||
+	    getExecState() != ExecutionState::Normal || getProgramState() != ProgramState::Main)
+		return;
+
+	auto &snaps = dynState.snapshots;
+	if (snaps.size() <= (unsigned) tid)
+		snaps.resize(tid + 1);
+	if (!snaps[tid].empty() &&
+	    snaps[tid].back()->thread.globalInstructions >= thr.globalInstructions)
+		return;
+
+	auto snap = std::make_shared<ThreadSnapshot>(
+		thr, thr.isMain() ? dynState.AtExitHandlers : std::vector<Function *>());
+	snap->thread.prefixLOC.clear();
+	snaps[tid].push_back(std::move(snap));
+}
+
+void Interpreter::dropSnapshots(int tid, unsigned int from)
+{
+	auto &snaps = dynState.snapshots;
+	if (snaps.size() <= (unsigned) tid)
+		return;
+
+	auto &ts = snaps[tid];
+	while (!ts.empty() && ts.back()->thread.globalInstructions >= from)
+		ts.pop_back();
+}
+
+void Interpreter::restoreSnapshots()
+{
+	auto &snaps = dynState.snapshots;
+	for (auto i = 0u; i < snaps.size() && i < getNumThreads(); i++) {
+		auto &thr = getThrById(i);
+
+		/* Threads that do not run in this execution stay as they are */
+		if (snaps[i].empty() || thr.ECStack.empty())
+			continue;
+
+		auto &snap = *snaps[i].back();
+		thr = snap.thread;
+		if (thr.isMain())
+			dynState.AtExitHandlers = snap.atExitHandlers;
+	}
+}
+
 void Interpreter::setupRecoveryRoutine(int tid)
 {
 	BUG_ON(tid >= getNumThreads());
@@ -198,6 +250,34 @@ void Interpreter::reclaimUnusedFd(int fd)
 	dynState.fds.reset(fd);
 }
 
+void Interpreter::setupFrameSlots(Module *mod)
+{
+	for (auto &fun : mod->getFunctionList()) {
+		for (auto &arg : fun.args())
+			addFrameSlot(&arg);
+		for (auto &i : instructions(fun))
+			if (!i.getType()->isVoidTy())
+				addFrameSlot(&i);
+	}
+}
+
+unsigned int Interpreter::addFrameSlot(const Value *V)
+{
+	const Function *fun = nullptr;
+	if (auto *arg = llvm::dyn_cast<Argument>(V))
+		fun = arg->getParent();
+	else if (auto *i = llvm::dyn_cast<Instruction>(V))
+		fun = i->getFunction();
+
+	/* Values that do not live in frames (e.g., inline asm) have no slot */
+	if (!fun)
+		return std::numeric_limits<unsigned int>::max();
+
+	auto slot = frameSizes[fun]++;
+	frameSlots[V] = slot;
+	return slot;
+}
+
 #if LLVM_VERSION_MAJOR >= 8
 # define GET_GV_ADDRESS_SPACE(v) (v).getAddressSpace()
 #else
@@ -396,6 +476,7 @@ Interpreter::Interpreter(std::unique_ptr<Module> M, std::unique_ptr<ModuleInfo>
 
   auto mod = Modules.back().get();
   collectStaticAddresses(mod);
+  setupFrameSlots(mod);
 
   /* Set up a dependency tracker if the model requires it */
   if (userConf->isDepTrackingModel)
@@ -408,6 +489,15 @@ Interpreter::Interpreter(std::unique_ptr<Module> M, std::unique_ptr<ModuleInfo>
   recoveryRoutine = mod->getFunction("__VERIFIER_recovery_routine");
   setupFsInfo(mod, userConf);
 
+  /* Random scheduling draws a number at every step */
+  runLocalInstsInline = (userConf->schedulePolicy != SchedulePolicy::random);
+
+  /* Checkpointing does not (yet) capture dependencies, the file
+   * system, or state that depends on other threads' progress */
+  if (!userConf->isDepTrackingModel && !userConf->persevere && !userConf->LAPOR &&
+      !userConf->helper && !this->MI->fsInfo.inodeTyp)
+	  checkpointInterval = userConf->checkpointInterval;
+
   /* Setup the interpreter for the exploration */
   auto mainFun = mod->getFunction(userConf->programEntryFun);
   ERROR_ON(!mainFun, "Could not find program's entry point function!\n");
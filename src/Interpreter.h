@@ -52,6 +52,7 @@
 #include "value_ptr.hpp"
 
 #include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/GenericValue.h>
 #include <llvm/IR/Instructions.h>
@@ -144,7 +145,9 @@ struct ExecutionContext {
   BasicBlock::iterator  CurInst;    // The next instruction to execute
   CallInstWrapper       Caller;     // Holds the call that called subframes.
                                     // NULL if main func or debugger invoked fn
-  std::map<Value *, GenericValue> Values; // LLVM values used in this invocation
+  std::vector<GenericValue> Values;   // LLVM values used in this invocation,
+                                      // indexed by frame slot (see getFrameSlot())
+  std::vector<bool> Assigned;         // Whether each slot has been assigned
   std::vector<GenericValue>  VarArgs; // Values passed through an ellipsis
   AllocaHolder Allocas;            // Track memory allocated by alloca
 
@@ -172,7 +175,7 @@ public:
 	unsigned int globalInstSnap;
 	BlockageType blocked;
 	MyRNG rng;
-	std::vector<std::pair<int, std::string> > prefixLOC;
+	std::vector<const llvm::DILocation *> prefixLOC; /* see getPrefixLOC() */
 
 	bool isMain() const { return id == 0; }
 
@@ -216,6 +219,25 @@ struct ThreadInfo {
 };
 
 
+/*
+ * Checkpointing: The state of a thread right after some of its events,
+ * from which the thread can resume instead of being replayed from its
+ * beginning. Snapshots are immutable, and thus shared between the
+ * saved states of the interpreter.
+ */
+struct ThreadSnapshot {
+	ThreadSnapshot(const Thread &thr, const std::vector<Function *> &handlers)
+		: thread(thr), atExitHandlers(handlers) {}
+
+	Thread thread;
+
+	/* The atexit() handlers registered so far (only for main()) */
+	std::vector<Function *> atExitHandlers;
+};
+
+/* The snapshots of each thread, in increasing position order */
+using SnapshotsT = std::vector<std::vector<std::shared_ptr<const ThreadSnapshot> > >;
+
 /* Pers: The state of the program -- i.e., part of the program being interpreted */
 enum class ProgramState {
 	Ctors,
@@ -261,6 +283,9 @@ struct DynamicComponents {
 	// AtExitHandlers - List of functions to call when the program exits,
 	// registered with the atexit() library function.
 	std::vector<Function*> AtExitHandlers;
+
+	/* Checkpointing: Snapshots of the threads taken during the exploration */
+	SnapshotsT snapshots;
 };
 
 using EELocalState = DynamicComponents;
@@ -318,9 +343,26 @@ protected:
   /* Pers: The recovery routine to run */
   Function *recoveryRoutine = nullptr;
 
+  /* Dense numbering of each function's SSA values (arguments and
+   * non-void instructions) into stack-frame slots, along with the
+   * number of slots of each function. Values created during
+   * execution (e.g., by intrinsic lowering) get a slot on first use */
+  llvm::DenseMap<const Value *, unsigned int> frameSlots;
+  llvm::DenseMap<const Function *, unsigned int> frameSizes;
+
+  /* The (line, file) of each debug location resolved so far */
+  std::unordered_map<const llvm::DILocation *, std::pair<int, std::string> > locCache;
+
   /* This is not exactly static but is reset to the same value each time*/
   std::vector<ExecutionContext> mainECStack;
 
+  /* Whether consecutive local instructions of a thread run without
+   * consulting the scheduler in between */
+  bool runLocalInstsInline = false;
+
+  /* Checkpointing: Every how many events threads are snapshotted (0 if disabled) */
+  unsigned int checkpointInterval = 0;
+
   IntrinsicLowering *IL;
 
   /*** Dynamic components (change during verification) ***/
@@ -356,17 +398,31 @@ public:
 	  SF.CurBB = &calledFun->front();
 	  SF.CurInst = SF.CurBB->begin();
 
-	  SF.Values[&*calledFun->arg_begin()] = PTR_TO_GV(ti.arg.get());
+	  SetValue(&*calledFun->arg_begin(), PTR_TO_GV(ti.arg.get()), SF);
 	  return createAddNewThread(calledFun, ti.arg, ti.id, ti.parentId, SF);
   }
   void setSharedState(std::unique_ptr<EESharedState> state) {
 	  dynState.alloctor = std::move(state->alloctor);
 	  dynState.fds = std::move(state->fds);
 	  dynState.threads.clear();
+	  dynState.snapshots.clear();
 	  for (auto &ti : state->threadInfos)
 		  constructAddThreadFromInfo(ti);
   }
 
+  /* Checkpointing: Snapshots thread TID at its current position */
+  void takeSnapshot(int tid);
+
+  /* Checkpointing: Drops the snapshots of TID that cover its events from FROM onwards */
+  void dropSnapshots(int tid, unsigned int from);
+
+  /* Checkpointing: Resumes each started thread from its latest snapshot.
+   * The driver is responsible for dropping invalidated snapshots */
+  void restoreSnapshots();
+
+  const SnapshotsT &getSnapshots() const { return dynState.snapshots; }
+  void setSnapshots(const SnapshotsT &snaps) { dynState.snapshots = snaps; }
+
   /* Blocks the current execution */
   void block(BlockageType t = BlockageType::Error ) {
 	  std::for_each(threads_begin(), threads_end(), [&](Thread &thr){ thr.block(t); });
@@ -516,6 +572,11 @@ public:
 
   /* Helper functions */
   void replayExecutionBefore(const VectorClock &before);
+
+  /* Returns the source line and file of the INDEX-th event of thread TID,
+   * as recorded by the last replay ({0, ""} if unknown) */
+  const std::pair<int, std::string> &getPrefixLOC(int tid, int index);
+
   SVal getLocInitVal(SAddr addr, AAccess access);
   unsigned int getTypeSize(Type *typ) const;
   SVal executeAtomicRMWOperation(SVal oldVal, SVal val, ASize size, AtomicRMWInst::BinOp op);
@@ -630,6 +691,28 @@ private:  // Helper functions
   void initializeExternalFunctions();
   GenericValue getConstantExprValue(ConstantExpr *CE, ExecutionContext &SF);
   GenericValue getOperandValue(Value *V, ExecutionContext &SF);
+  void SetValue(Value *V, GenericValue Val, ExecutionContext &SF);
+
+  /* Numbers the SSA values of all functions in MOD into frame slots */
+  void setupFrameSlots(Module *mod);
+
+  /* Returns the frame slot of V (an argument or an instruction) */
+  unsigned int getFrameSlot(const Value *V) {
+	  auto it = frameSlots.find(V);
+	  return (it != frameSlots.end()) ? it->second : addFrameSlot(V);
+  }
+  unsigned int addFrameSlot(const Value *V);
+
+  /* Returns the slot of V in SF for writing, marking it as assigned */
+  GenericValue &getAssignedSlot(Value *V, ExecutionContext &SF);
+
+  /* Fast path for integers of at most 64 bits (and pointers): values are
+   * read as zero-extended words, and integers are written as such */
+  uint64_t getSmallOperandValue(Value *V, ExecutionContext &SF);
+  void setSmallIntValue(Value *V, unsigned width, uint64_t val, ExecutionContext &SF);
+
+  /* Executes I on words if its type allows; returns whether it did */
+  bool executeSmallIntInst(BinaryOperator &I, ExecutionContext &SF);
   GenericValue executeTruncInst(Value *SrcVal, Type *DstTy,
                                 ExecutionContext &SF);
   GenericValue executeSExtInst(Value *SrcVal, Type *DstTy,
@@ -450,6 +450,7 @@ void LKMMDriver::calcStartViews(ThreadStartLabel *lab)
 
 void LKMMDriver::updateLabelViews(EventLabel *lab, const EventDeps *deps)
 {
+	GENMC_TIME_PHASE(UpdateLabelViews);
 	const auto &g = getGraph();
 
 	switch (lab->getKind()) {
@@ -1097,6 +1098,7 @@ void LKMMDriver::changeRf(Event read, Event store)
 	auto &g = getGraph();
 
 	/* Change the reads-from relation in the graph */
+	invalidateCheckpoints(read);
 	g.changeRf(read, store);
 
 	/* And update the views of the load */
@@ -0,0 +1,169 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#include "LabelAllocator.hpp"
+#include "Error.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+thread_local LabelAllocator::PoolHandle LabelAllocator::handle;
+
+namespace {
+	/* All pools ever created, and the ones no thread is using.
+	 * Never destroyed, as labels may outlive static destructors */
+	struct PoolRegistry {
+		std::mutex mutex;
+		std::vector<void *> all;
+		std::vector<void *> unused;
+	};
+
+	PoolRegistry &getRegistry()
+	{
+		static auto *registry = new PoolRegistry();
+		return *registry;
+	}
+}
+
+LabelAllocator::PoolHandle::~PoolHandle()
+{
+	if (!pool)
+		return;
+
+	auto &r = getRegistry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	r.unused.push_back(pool);
+	pool = nullptr;
+}
+
+LabelAllocator::Pool &LabelAllocator::acquirePool()
+{
+	auto &r = getRegistry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	if (!r.unused.empty()) {
+		handle.pool = static_cast<Pool *>(r.unused.back());
+		r.unused.pop_back();
+	} else {
+		handle.pool = new Pool();
+		r.all.push_back(handle.pool);
+	}
+	return *handle.pool;
+}
+
+long long LabelAllocator::getBytesInUse()
+{
+	auto &r = getRegistry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	auto result = 0ll;
+	for (auto *p : r.all)
+		result += static_cast<Pool *>(p)->bytesInUse.load(std::memory_order_relaxed);
+	return result;
+}
+
+long long LabelAllocator::getBlocksInUse()
+{
+	auto &r = getRegistry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+
+	auto result = 0ll;
+	for (auto *p : r.all)
+		result += static_cast<Pool *>(p)->blocksInUse.load(std::memory_order_relaxed);
+	return result;
+}
+
+void *LabelAllocator::carve(Pool &p, std::size_t cls)
+{
+	auto size = (cls + 1) * granularity;
+	if (static_cast<std::size_t>(p.end - p.cur) < size) {
+		/* Put the remainder of the old chunk on the free lists */
+		while (static_cast<std::size_t>(p.end - p.cur) >= granularity) {
+			auto c = std::min<std::size_t>((p.end - p.cur) / granularity, numClasses) - 1;
+			auto *block = reinterpret_cast<FreeBlock *>(p.cur);
+			block->next = p.freeLists[c];
+			p.freeLists[c] = block;
+			p.cur += (c + 1) * granularity;
+		}
+
+		void *mem = nullptr;
+		if (posix_memalign(&mem, chunkSize, chunkSize))
+			ERROR("Could not allocate memory for labels!\n");
+		auto *chunk = static_cast<char *>(mem);
+		reinterpret_cast<ChunkHeader *>(chunk)->owner = &p;
+		p.cur = chunk + granularity;
+		p.end = chunk + chunkSize;
+	}
+
+	auto *block = p.cur;
+	p.cur += size;
+	return block;
+}
+
+void *LabelAllocator::allocate(std::size_t size)
+{
+	auto &p = getPool();
+	addCount(p.bytesInUse, size);
+	addCount(p.blocksInUse, 1);
+	if (size > maxPooledSize)
+		return ::operator new(size);
+
+	auto cls = getClass(size);
+	if (auto *block = p.freeLists[cls]) {
+		p.freeLists[cls] = block->next;
+		return block;
+	}
+	if (auto *block = p.remoteLists[cls].exchange(nullptr, std::memory_order_acquire)) {
+		p.freeLists[cls] = block->next;
+		return block;
+	}
+	return carve(p, cls);
+}
+
+void LabelAllocator::deallocate(void *ptr, std::size_t size)
+{
+	if (!ptr)
+		return;
+
+	auto &p = getPool();
+	addCount(p.bytesInUse, -(long long) size);
+	addCount(p.blocksInUse, -1);
+	if (size > maxPooledSize) {
+		::operator delete(ptr);
+		return;
+	}
+
+	auto cls = getClass(size);
+	auto *block = static_cast<FreeBlock *>(ptr);
+	auto *owner = getOwner(ptr);
+	if (owner == &p) {
+		block->next = p.freeLists[cls];
+		p.freeLists[cls] = block;
+		return;
+	}
+
+	/* The owner takes the whole list at once, so there is no ABA */
+	auto &head = owner->remoteLists[cls];
+	auto *old = head.load(std::memory_order_relaxed);
+	do {
+		block->next = old;
+	} while (!head.compare_exchange_weak(old, block, std::memory_order_release,
+					     std::memory_order_relaxed));
+}
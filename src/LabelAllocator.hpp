@@ -0,0 +1,125 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __LABEL_ALLOCATOR_HPP__
+#define __LABEL_ALLOCATOR_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*******************************************************************************
+ **                         LabelAllocator Class
+ ******************************************************************************/
+
+/*
+ * Pool allocator for event labels. Graphs create and destroy labels at
+ * a very high rate (e.g., on every copy or restriction), so labels are
+ * bump-allocated from large chunks and recycled through per-size free
+ * lists instead of going through the general-purpose allocator.
+ *
+ * Each thread allocates from its own pool, so no synchronization is
+ * needed in the common case. Since graphs may migrate across threads,
+ * a label may be freed by a thread other than the one that allocated
+ * it. Such a label is handed back to the pool that owns its chunk
+ * (chunks are aligned to their size, so the owner is found by masking
+ * the address), so that it is reused instead of piling up at the
+ * freeing thread. Pools are never destroyed: the pool of an exiting
+ * thread is adopted by the next thread that needs one.
+ */
+class LabelAllocator {
+
+public:
+	/* Returns a block of at least SIZE bytes */
+	static void *allocate(std::size_t size);
+
+	/* Returns a block of SIZE bytes obtained by allocate() */
+	static void deallocate(void *p, std::size_t size);
+
+	/* Returns the number of bytes (resp. labels) in use by all threads */
+	static long long getBytesInUse();
+	static long long getBlocksInUse();
+
+private:
+	/* Blocks are handed out in multiples of this (also their alignment) */
+	static constexpr std::size_t granularity = 16;
+
+	/* Blocks larger than this are passed to the system allocator */
+	static constexpr std::size_t maxPooledSize = 1024;
+
+	/* The size (and alignment) of the chunks that blocks are carved from */
+	static constexpr std::size_t chunkSize = 256 * 1024;
+
+	static constexpr std::size_t numClasses = maxPooledSize / granularity;
+
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	/* Allocation state of a thread. Only the thread using the pool
+	 * touches its free lists; other threads return the blocks of
+	 * its chunks through the (lock-free) remote lists. The counters
+	 * are only written by the thread using the pool */
+	struct Pool {
+		FreeBlock *freeLists[numClasses];
+		std::atomic<FreeBlock *> remoteLists[numClasses];
+		char *cur;
+		char *end;
+		std::atomic<long long> bytesInUse;
+		std::atomic<long long> blocksInUse;
+	};
+
+	/* Stored at the beginning of each chunk */
+	struct ChunkHeader {
+		Pool *owner;
+	};
+	static_assert(sizeof(ChunkHeader) <= granularity, "Chunk header too large!");
+
+	/* Hands the pool of a thread over to the next thread, when it exits */
+	struct PoolHandle {
+		Pool *pool = nullptr;
+		~PoolHandle();
+	};
+
+	static std::size_t getClass(std::size_t size) {
+		return (size + granularity - 1) / granularity - 1;
+	}
+
+	static Pool *getOwner(void *p) {
+		auto chunk = reinterpret_cast<std::uintptr_t>(p) & ~(chunkSize - 1);
+		return reinterpret_cast<ChunkHeader *>(chunk)->owner;
+	}
+
+	/* Returns the pool of the calling thread */
+	static Pool &getPool() {
+		return handle.pool ? *handle.pool : acquirePool();
+	}
+	static Pool &acquirePool();
+
+	/* Carves a block of class CLS out of the current chunk,
+	 * grabbing a new chunk if necessary */
+	static void *carve(Pool &p, std::size_t cls);
+
+	static void addCount(std::atomic<long long> &c, long long n) {
+		c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	static thread_local PoolHandle handle;
+};
+
+#endif /* __LABEL_ALLOCATOR_HPP__ */
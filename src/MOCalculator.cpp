@@ -21,6 +21,7 @@
 #include "MOCalculator.hpp"
 #include "ExecutionGraph.hpp"
 #include "GraphIterators.hpp"
+#include "TaskPool.hpp"
 #include <vector>
 
 CoherenceCalculator::const_store_iterator
@@ -386,14 +387,19 @@ void MOCalculator::initCalc()
 	auto &coRelation = gm.getPerLocRelation(ExecutionGraph::RelationId::co);
 
 	coRelation.clear();
+	std::vector<GlobalRelation *> toClose;
 	for (auto locIt = begin(); locIt != end(); locIt++) {
 		coRelation[locIt->first] = GlobalRelation(getStoresToLoc(locIt->first));
 		if (locIt->second.empty())
 			continue;
 		for (auto sIt = locIt->second.begin(); sIt != locIt->second.end() - 1; sIt++)
 			coRelation[locIt->first].addEdge(*sIt, *(sIt + 1));
-		coRelation[locIt->first].transClosure();
+		toClose.push_back(&coRelation[locIt->first]);
 	}
+
+	/* The map is not touched from here on, so the closures can be
+	 * computed concurrently */
+	TaskPool::parallelFor(toClose.size(), [&](std::size_t i){ toClose[i]->transClosure(); });
 	return;
 }
 
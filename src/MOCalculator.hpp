@@ -99,6 +99,8 @@ public:
 
 	Calculator::CalculationResult doCalc() override;
 
+	bool isIndependent() const override { return true; }
+
 	/* Stops tracking all stores not included in "preds" in the graph */
 	void removeAfter(const VectorClock &preds) override;
 
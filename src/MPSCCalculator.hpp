@@ -66,6 +66,16 @@ private:
 
 	Calculator::CalculationResult addPscConstraints();
 	void calcPscRelation();
+
+	/* Returns true if mpsc is acyclic. Only calculates the transitive
+	 * closure if others query mpsc through it; otherwise, it searches
+	 * for cycles along the edges, unless the last verdict is still
+	 * fresh and the graph has only grown since */
+	bool isPscAcyclic();
+
+	/* The last verdict of isPscAcyclic(), and the graph it was given for */
+	bool verdictAcyclic = false;
+	unsigned int verdictChanges = 0;
 };
 
 #endif /* __MPSC_CALCULATOR_HPP__ */
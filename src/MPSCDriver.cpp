@@ -222,6 +222,7 @@ void MPSCDriver::calcJoinViews(ThreadJoinLabel *lab)
 
 void MPSCDriver::updateLabelViews(EventLabel *lab, const EventDeps *deps) /* deps ignored */
 {
+	GENMC_TIME_PHASE(UpdateLabelViews);
 	const auto &g = getGraph();
 
 	switch (lab->getKind()) {
@@ -404,6 +405,7 @@ void MPSCDriver::changeRf(Event read, Event store)
 	auto &g = getGraph();
 
 	/* Change the reads-from relation in the graph */
+	invalidateCheckpoints(read);
 	g.changeRf(read, store);
 
 	/* And update the views of the load */
@@ -418,6 +420,7 @@ void MPSCDriver::changeRf(Channel ch , Event receive, Event send)
 {
 	auto &g = getGraph();
 	/* Change the reads-from relation in the graph */
+	invalidateCheckpoints(receive);
 	g.changeRf(ch, receive, send);
 
 	/* And update the views of the load */
@@ -25,11 +25,12 @@ void PBCalculator::initCalc()
 {
 	auto &g = getGraph();
 	auto &prop = g.getGlobalRelation(ExecutionGraph::RelationId::prop);
-	auto &pb = g.getGlobalRelation(ExecutionGraph::RelationId::pb);
 
 	/* pb should have the same events as prop and ar */
 	auto events = prop.getElems();
-	pb = Calculator::GlobalRelation(std::move(events));
+	g.resetGlobalRelation(ExecutionGraph::RelationId::pb,
+		Calculator::GlobalRelation(std::move(events),
+			g.getRelationBackend(ExecutionGraph::RelationId::pb)));
 	return;
 }
 
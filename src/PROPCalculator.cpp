@@ -23,7 +23,6 @@
 void PROPCalculator::initCalc()
 {
 	auto &g = getGraph();
-	auto &prop = g.getGlobalRelation(ExecutionGraph::RelationId::prop);
 
 	/* Collect all atomic accesses and fences */
 	auto events = g.collectAllEvents([&](const EventLabel *lab)
@@ -60,7 +59,9 @@ void PROPCalculator::initCalc()
 		events.end());
 
 	/* Populate an initial PROP relation */
-	prop = Calculator::GlobalRelation(std::move(events));
+	g.resetGlobalRelation(ExecutionGraph::RelationId::prop,
+		Calculator::GlobalRelation(std::move(events),
+			g.getRelationBackend(ExecutionGraph::RelationId::prop)));
 	return;
 }
 
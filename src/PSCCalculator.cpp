@@ -58,7 +58,7 @@ std::vector<Event> PSCCalculator::calcSCFencesSuccs(const std::vector<Event> &fc
 						     const Event e) const
 {
 	auto &g = getGraph();
-	auto &hbRelation = g.getGlobalRelation(ExecutionGraph::RelationId::hb);
+	auto &hbRelation = g.getHbRelation();
 	std::vector<Event> succs;
 
 	if (g.isRMWLoad(e))
@@ -74,7 +74,7 @@ std::vector<Event> PSCCalculator::calcSCFencesPreds(const std::vector<Event> &fc
 						     const Event e) const
 {
 	auto &g = getGraph();
-	auto &hbRelation = g.getGlobalRelation(ExecutionGraph::RelationId::hb);
+	auto &hbRelation = g.getHbRelation();
 	std::vector<Event> preds;
 
 	if (g.isRMWLoad(e))
@@ -234,7 +234,7 @@ void PSCCalculator::addSCEcosLoc(const std::vector<Event> &fcs,
 void PSCCalculator::addSbHbEdges(Calculator::GlobalRelation &matrix) const
 {
 	auto &g = getGraph();
-	auto &hbRelation = g.getGlobalRelation(ExecutionGraph::RelationId::hb);
+	auto &hbRelation = g.getHbRelation();
 
 	auto &scs = matrix.getElems();
 	for (auto i = 0u; i < scs.size(); i++) {
@@ -350,10 +350,50 @@ void PSCCalculator::calcPscRelation()
 	 * and add the rest of PSC_base and PSC_fence
 	 */
 	addSCEcos(fcs, getDoubleLocs(), pscRelation);
-	pscRelation.transClosure();
 	return;
 }
 
+bool PSCCalculator::isPscAcyclic()
+{
+	auto &g = getGraph();
+	auto &pscRelation = g.getGlobalRelation(ExecutionGraph::RelationId::psc);
+
+	/* WB (and AR) query psc through its closure: calculate it in full */
+	if (llvm::isa<WBCalculator>(g.getCoherenceCalculator()) ||
+	    g.hasCalculator(ExecutionGraph::RelationId::ar)) {
+		verdictAcyclic = false;
+		pscRelation.transClosure();
+		return pscRelation.isIrreflexive();
+	}
+
+	/*
+	 * If the graph has only grown since the last (positive) verdict,
+	 * the edges between the events it covered are still the same,
+	 * so any new cycle has to go through one of the added events.
+	 * This relies on the driver only appending events at the end of
+	 * their threads, assigning rfs only through changeRf() (which
+	 * notes a change for reads covered by the last check), and adding
+	 * new writes either co-maximal or right after the write their RMW
+	 * reads from; any other co/so offset change is noted as well.
+	 * Such an event reads from (or is placed after) events that were
+	 * already there, and nothing is ordered after it yet, so it has
+	 * no outgoing psc edge and cannot close a cycle: the graph
+	 * is still acyclic
+	 */
+	auto acyclic = true;
+	if (verdictAcyclic && verdictChanges == g.getNonAdditiveChanges()) {
+		GENMC_COUNT_INCREMENTAL("pscIncremental");
+		GENMC_DEBUG(BUG_ON(!pscRelation.isAcyclic()););
+	} else {
+		GENMC_COUNT_INCREMENTAL("pscFull");
+		acyclic = pscRelation.isAcyclic();
+	}
+
+	verdictAcyclic = acyclic;
+	verdictChanges = g.getNonAdditiveChanges();
+	return acyclic;
+}
+
 Calculator::CalculationResult PSCCalculator::addPscConstraints()
 {
 	auto &g = getGraph();
@@ -375,27 +415,28 @@ Calculator::CalculationResult PSCCalculator::addPscConstraints()
 void PSCCalculator::initCalc()
 {
 	auto &g = getGraph();
-	auto &pscRelation = g.getGlobalRelation(ExecutionGraph::RelationId::psc);
 
 	/* Collect all SC events (except for RMW loads) */
 	auto accesses = getGraph().getSCs();
 
-	pscRelation = Calculator::GlobalRelation(accesses.first);
+	g.resetGlobalRelation(ExecutionGraph::RelationId::psc,
+		Calculator::GlobalRelation(accesses.first,
+			g.getRelationBackend(ExecutionGraph::RelationId::psc)));
 	return;
 }
 
 Calculator::CalculationResult PSCCalculator::doCalc()
 {
 	auto &g = getGraph();
-	auto &hbRelation = g.getGlobalRelation(ExecutionGraph::RelationId::hb);
+	auto &hbRelation = g.getHbRelation();
 	auto &pscRelation = g.getGlobalRelation(ExecutionGraph::RelationId::psc);
 	auto &coRelation = g.getPerLocRelation(ExecutionGraph::RelationId::co);
 
-	hbRelation.transClosure();
+	/* hb is closed by doInits() (and by LAPOR, when it adds edges) */
 	if (!hbRelation.isIrreflexive())
 		return Calculator::CalculationResult(false, false);
 	calcPscRelation();
-	if (!pscRelation.isIrreflexive())
+	if (!isPscAcyclic())
 		return Calculator::CalculationResult(false, false);
 
 	auto result = addPscConstraints();
@@ -414,6 +455,7 @@ Calculator::CalculationResult PSCCalculator::doCalc()
 
 void PSCCalculator::removeAfter(const VectorClock &preds)
 {
-	/* We do not track anything specific for PSC */
+	/* Any verdict given for the removed events is stale */
+	verdictAcyclic = false;
 	return;
 }
@@ -82,6 +82,16 @@ private:
 
 	Calculator::CalculationResult addPscConstraints();
 	void calcPscRelation();
+
+	/* Returns true if psc is acyclic. Only calculates the transitive
+	 * closure if others query psc through it; otherwise, it searches
+	 * for cycles along the edges, unless the last verdict is still
+	 * fresh and the graph has only grown since */
+	bool isPscAcyclic();
+
+	/* The last verdict of isPscAcyclic(), and the graph it was given for */
+	bool verdictAcyclic = false;
+	unsigned int verdictChanges = 0;
 };
 
 #endif /* __PSC_CALCULATOR_HPP__ */
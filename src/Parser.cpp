@@ -19,7 +19,44 @@
  */
 
 #include "Parser.hpp"
+#include <llvm/Support/MemoryBuffer.h>
 #include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+	/* A source file mapped in memory, along with the offsets of its lines */
+	struct SourceFile {
+		std::unique_ptr<llvm::MemoryBuffer> buf;
+		std::vector<size_t> lineStarts;
+	};
+}
+
+/* Loads each source file once, and indexes its lines */
+static const SourceFile &getSourceFile(const std::string &absPath)
+{
+	static std::unordered_map<std::string, SourceFile> cache;
+	static std::mutex cacheMutex;
+
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto it = cache.find(absPath);
+	if (it != cache.end())
+		return it->second;
+
+	auto &file = cache[absPath];
+	auto bufOrErr = llvm::MemoryBuffer::getFile(absPath);
+	if (!bufOrErr)
+		return file;
+
+	file.buf = std::move(*bufOrErr);
+	auto data = file.buf->getBuffer();
+	file.lineStarts.push_back(0);
+	for (auto i = 0u; i < data.size(); i++)
+		if (data[i] == '\n')
+			file.lineStarts.push_back(i + 1);
+	return file;
+}
 
 string Parser::readFile(const string &fileName)
 {
@@ -36,15 +73,14 @@ string Parser::readFile(const string &fileName)
 
 std::string Parser::getFileLineByNumber(const std::string &absPath, int line)
 {
-	std::ifstream ifs(absPath);
-	std::string s;
-	int curLine = 0;
-
-	while (ifs.good() && curLine < line) {
-		std::getline(ifs, s);
-		++curLine;
-	}
-	return s;
+	auto &file = getSourceFile(absPath);
+	if (!file.buf || line <= 0 || line > (int) file.lineStarts.size())
+		return "";
+
+	auto data = file.buf->getBuffer();
+	auto start = file.lineStarts[line - 1];
+	auto end = data.find('\n', start);
+	return data.slice(start, end).str();
 }
 
 void Parser::stripWhitespace(std::string &s)
@@ -62,7 +98,7 @@ void Parser::stripSlashes(std::string &absPath)
 		absPath = absPath.substr(i + 1);
 }
 
-void Parser::parseInstFromMData(std::pair<int, std::string> &locAndFile,
+void Parser::parseInstFromMData(const std::pair<int, std::string> &locAndFile,
 				std::string functionName,
 				llvm::raw_ostream &os /* llvm::outs() */)
 {
@@ -36,7 +36,7 @@ public:
 	static std::string getFileLineByNumber(const std::string &absPath, int line);
 	static void stripWhitespace(std::string &s);
 	static void stripSlashes(std::string &absPath);
-	static void parseInstFromMData(std::pair<int, std::string> &locAndFile,
+	static void parseInstFromMData(const std::pair<int, std::string> &locAndFile,
 				       std::string functionName,
 				       llvm::raw_ostream &os = llvm::dbgs());
 };
@@ -205,6 +205,7 @@ void RC11Driver::calcJoinViews(ThreadJoinLabel *lab)
 
 void RC11Driver::updateLabelViews(EventLabel *lab, const EventDeps *deps) /* deps ignored */
 {
+	GENMC_TIME_PHASE(UpdateLabelViews);
 	const auto &g = getGraph();
 
 	switch (lab->getKind()) {
@@ -378,6 +379,7 @@ void RC11Driver::changeRf(Event read, Event store)
 	auto &g = getGraph();
 
 	/* Change the reads-from relation in the graph */
+	invalidateCheckpoints(read);
 	g.changeRf(read, store);
 
 	/* And update the views of the load */
@@ -27,7 +27,8 @@ void RCUCalculator::initCalc()
 	auto &rcu = g.getGlobalRelation(ExecutionGraph::RelationId::rcu);
 
 
-	rcu = Calculator::GlobalRelation(rcuLink.getElems());
+	rcu = Calculator::GlobalRelation(rcuLink.getElems(),
+		g.getRelationBackend(ExecutionGraph::RelationId::rcu));
 	return;
 }
 
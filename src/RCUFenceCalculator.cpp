@@ -31,7 +31,8 @@ void RCUFenceCalculator::initCalc()
 						 return PROPCalculator::isNonTrivial(lab);
 					 });
 
-	rcuFence = Calculator::GlobalRelation(std::move(events));
+	rcuFence = Calculator::GlobalRelation(std::move(events),
+		g.getRelationBackend(ExecutionGraph::RelationId::rcu_fence));
 	return;
 }
 
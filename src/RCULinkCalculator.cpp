@@ -32,7 +32,8 @@ void RCULinkCalculator::initCalc()
 							   llvm::isa<RCULockLabelLKMM>(lab);
 					    });
 
-	rcu = Calculator::GlobalRelation(std::move(rcuEvents));
+	rcu = Calculator::GlobalRelation(std::move(rcuEvents),
+		g.getRelationBackend(ExecutionGraph::RelationId::rcu_link));
 	return;
 }
 
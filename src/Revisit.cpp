@@ -29,6 +29,12 @@ llvm::raw_ostream& operator<<(llvm::raw_ostream& s,  const Revisit::Kind k)
 	case Revisit::RV_BRev:
 		s << "BR";
 		break;
+	case Revisit::RV_BRevHelper:
+		s << "BR-Helper";
+		break;
+	case Revisit::RV_FRevRecv:
+		s << "FR-Recv";
+		break;
 	case Revisit::RV_BRevSR:
 		s << "BR-SendToRecv";
 		break;
@@ -41,6 +47,9 @@ llvm::raw_ostream& operator<<(llvm::raw_ostream& s,  const Revisit::Kind k)
 	case Revisit::RV_SO:
 		s << "SO";
 		break;
+	case Revisit::RV_Opt:
+		s << "Opt";
+		break;
 	default:
 		PRINT_BUGREPORT_INFO_ONCE("print-revisit-type", "Cannot print revisit type");
 		s << "UNKNOWN";
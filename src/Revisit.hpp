@@ -243,7 +243,7 @@ protected:
 		: ReceiveRevisit(k, p, r), maximal(maximal) {}
 
 public:
-	ForwardRecvRevisit(Event p, Event r, bool maximal = false) : ForwardRecvRevisit(RV_FRev, p, r, maximal) {}
+	ForwardRecvRevisit(Event p, Event r, bool maximal = false) : ForwardRecvRevisit(RV_FRevRecv, p, r, maximal) {}
 
 	bool isMaximal() const { return maximal; }
 
@@ -30,6 +30,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 /*******************************************************************************
  **                           SExprVisitor Class
@@ -372,6 +373,37 @@ private:
 };
 
 
+/*******************************************************************************
+ **                           SExprRegCollector Class
+ ******************************************************************************/
+
+/*
+ * Collects the registers an expression uses.
+ */
+
+template<typename T>
+class SExprRegCollector : public SExprVisitor<SExprRegCollector, T> {
+
+public:
+	/* Returns the registers used in E (possibly with duplicates) */
+	std::vector<T> collect(const SExpr<T> *e) {
+		regs.clear();
+		this->visit(const_cast<SExpr<T> *>(e));
+		return regs;
+	}
+
+	void visitRegisterExpr(RegisterExpr<T> &e) { regs.push_back(e.getRegister()); }
+
+	void visitSExpr(SExpr<T> &e) {
+		for (auto i = 0u; i < e.getNumKids(); i++)
+			this->visit(e.getKid(i));
+	}
+
+private:
+	std::vector<T> regs;
+};
+
+
 /*******************************************************************************
  **                           SExprConcretizer Class
  ******************************************************************************/
@@ -0,0 +1,197 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+/*
+ * Micro-benchmark for the kernels of SIMDKernels: compares the
+ * dispatched (vectorized) kernels against scalar code, and the
+ * transitive closure over BitRow rows (as used by AdjList) against
+ * llvm::BitVector rows, and the dense backend of AdjList against the
+ * sparse one.
+ */
+
+#include "AdjList.hpp"
+#include "BitRow.hpp"
+#include "Event.hpp"
+#include "SIMDKernels.hpp"
+#include "View.hpp"
+#include <llvm/ADT/BitVector.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+template <typename F>
+static double timeIt(unsigned int reps, F&& fun)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (auto r = 0u; r < reps; r++)
+		fun();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(end - start).count() / reps;
+}
+
+static void report(const char *what, double base, double curr)
+{
+	llvm::outs() << llvm::format("%-32s %12.3f %12.3f %8.2fx\n", what, base, curr, base / curr);
+}
+
+static void benchViews(std::mt19937 &rng, unsigned int n)
+{
+	std::uniform_int_distribution<int> dist(0, 1000);
+	std::vector<int> a(n), b(n);
+	for (auto i = 0u; i < n; i++) {
+		a[i] = dist(rng);
+		b[i] = dist(rng);
+	}
+
+	auto reps = 2000000u / n + 1;
+	auto tmp = a;
+	auto base = timeIt(reps, [&]{
+		tmp = a;
+		SIMDKernels::scalar::maxInto(tmp.data(), b.data(), n);
+	});
+	auto curr = timeIt(reps, [&]{
+		tmp = a;
+		SIMDKernels::maxInto(tmp.data(), b.data(), n);
+	});
+	std::string what = "maxInto (n=" + std::to_string(n) + ")";
+	report(what.c_str(), base, curr);
+
+	/* Worst case for the search: no element is greater */
+	base = timeIt(reps, [&]{ SIMDKernels::scalar::findFirstGreater(a.data(), a.data(), n); });
+	curr = timeIt(reps, [&]{ SIMDKernels::findFirstGreater(a.data(), a.data(), n); });
+	what = "findFirstGreater (n=" + std::to_string(n) + ")";
+	report(what.c_str(), base, curr);
+
+	View va, vb;
+	for (auto i = 0u; i < n; i++) {
+		va[i] = a[i];
+		vb[i] = b[i];
+	}
+	base = timeIt(reps, [&]{
+		View v(va);
+		for (auto i = 0u; i < n; i++)
+			if (v[i] < vb[i])
+				v[i] = vb[i];
+	});
+	curr = timeIt(reps, [&]{ View v(va); v.update(vb); });
+	what = "View::update (n=" + std::to_string(n) + ")";
+	report(what.c_str(), base, curr);
+}
+
+/* Closure in DFS post-order, as done by AdjList::transClosure() */
+template <typename Row>
+static void closeRows(const std::vector<std::vector<unsigned int> > &succ,
+		      std::vector<Row> &transC)
+{
+	std::vector<char> visited(succ.size(), 0);
+	std::function<void(unsigned int)> visit = [&](unsigned int i){
+		visited[i] = 1;
+		for (auto j : succ[i])
+			if (!visited[j])
+				visit(j);
+		for (auto j : succ[i]) {
+			transC[i] |= transC[j];
+			transC[i].set(j);
+		}
+	};
+	for (auto i = 0u; i < succ.size(); i++)
+		if (!visited[i])
+			visit(i);
+}
+
+static void benchClosure(std::mt19937 &rng, unsigned int n)
+{
+	/* A random DAG with ~4 successors per node */
+	std::vector<std::vector<unsigned int> > succ(n);
+	for (auto i = 0u; i + 1 < n; i++) {
+		std::uniform_int_distribution<unsigned int> dist(i + 1, n - 1);
+		for (auto k = 0u; k < 4; k++)
+			succ[i].push_back(dist(rng));
+	}
+
+	auto reps = 20000u / n + 1;
+	auto base = timeIt(reps, [&]{
+		std::vector<llvm::BitVector> transC(n, llvm::BitVector(n));
+		closeRows(succ, transC);
+	});
+	auto curr = timeIt(reps, [&]{
+		std::vector<BitRow> transC(n, BitRow(n));
+		closeRows(succ, transC);
+	});
+	std::string what = "transClosure (n=" + std::to_string(n) + ")";
+	report(what.c_str(), base, curr);
+}
+
+/* Builds, closes, and queries a relation over the events of 8 threads */
+static void benchRelation(std::mt19937 &rng, unsigned int n)
+{
+	using Relation = AdjList<Event, EventHasher>;
+
+	std::vector<Event> es;
+	for (auto i = 0u; i < n; i++)
+		es.push_back(Event(i % 8, 1 + i / 8));
+
+	std::vector<std::pair<unsigned int, unsigned int> > edges;
+	for (auto i = 0u; i + 1 < n; i++) {
+		std::uniform_int_distribution<unsigned int> dist(i + 1, n - 1);
+		for (auto k = 0u; k < 4; k++)
+			edges.push_back(std::make_pair(i, dist(rng)));
+	}
+
+	auto run = [&](Relation::Backend b){
+		Relation r(es, b);
+		for (auto &e : edges)
+			r.addEdge(es[e.first], es[e.second]);
+		r.transClosure();
+
+		auto count = 0u;
+		for (auto &a : es)
+			for (auto &c : es)
+				count += r(a, c);
+		return count;
+	};
+
+	auto reps = 20000u / n + 1;
+	auto base = timeIt(reps, [&]{ run(Relation::Backend::sparse); });
+	auto curr = timeIt(reps, [&]{ run(Relation::Backend::dense); });
+	BUG_ON(run(Relation::Backend::sparse) != run(Relation::Backend::dense));
+	std::string what = "dense relation (n=" + std::to_string(n) + ")";
+	report(what.c_str(), base, curr);
+}
+
+int main(int argc, char **argv)
+{
+	std::mt19937 rng(42);
+
+	llvm::outs() << "Kernels in use: " << SIMDKernels::getImplName() << "\n";
+	llvm::outs() << llvm::format("%-32s %12s %12s %9s\n", (const char *) "Benchmark",
+				     (const char *) "Base (us)", (const char *) "Curr (us)",
+				     (const char *) "Speedup");
+
+	for (auto n : {8u, 32u, 128u, 512u})
+		benchViews(rng, n);
+	for (auto n : {64u, 256u, 1024u, 4096u})
+		benchClosure(rng, n);
+	for (auto n : {64u, 256u, 1024u})
+		benchRelation(rng, n);
+	return 0;
+}
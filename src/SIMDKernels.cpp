@@ -0,0 +1,191 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#include "SIMDKernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define GENMC_X86_KERNELS
+# include <immintrin.h>
+#endif
+
+/************************************************************
+ ** Scalar kernels
+ ***********************************************************/
+
+unsigned int SIMDKernels::scalar::findFirstGreater(const int *a, const int *b, unsigned int n)
+{
+	for (auto i = 0u; i < n; i++)
+		if (b[i] > a[i])
+			return i;
+	return n;
+}
+
+void SIMDKernels::scalar::maxInto(int *a, const int *b, unsigned int n)
+{
+	for (auto i = 0u; i < n; i++)
+		if (a[i] < b[i])
+			a[i] = b[i];
+}
+
+void SIMDKernels::scalar::orInto(uint64_t *a, const uint64_t *b, unsigned int n)
+{
+	for (auto i = 0u; i < n; i++)
+		a[i] |= b[i];
+}
+
+#ifdef GENMC_X86_KERNELS
+
+/************************************************************
+ ** SSE4.1 kernels
+ ***********************************************************/
+
+__attribute__((target("sse4.1")))
+static unsigned int findFirstGreaterSSE(const int *a, const int *b, unsigned int n)
+{
+	auto i = 0u;
+	for (; i + 4 <= n; i += 4) {
+		auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+		auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+		auto mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(vb, va)));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return i + SIMDKernels::scalar::findFirstGreater(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void maxIntoSSE(int *a, const int *b, unsigned int n)
+{
+	auto i = 0u;
+	for (; i + 4 <= n; i += 4) {
+		auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+		auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(a + i), _mm_max_epi32(va, vb));
+	}
+	SIMDKernels::scalar::maxInto(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void orIntoSSE(uint64_t *a, const uint64_t *b, unsigned int n)
+{
+	auto i = 0u;
+	for (; i + 2 <= n; i += 2) {
+		auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+		auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(a + i), _mm_or_si128(va, vb));
+	}
+	SIMDKernels::scalar::orInto(a + i, b + i, n - i);
+}
+
+/************************************************************
+ ** AVX2 kernels
+ ***********************************************************/
+
+__attribute__((target("avx2")))
+static unsigned int findFirstGreaterAVX2(const int *a, const int *b, unsigned int n)
+{
+	auto i = 0u;
+	for (; i + 8 <= n; i += 8) {
+		auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+		auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+		auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(vb, va)));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return i + SIMDKernels::scalar::findFirstGreater(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void maxIntoAVX2(int *a, const int *b, unsigned int n)
+{
+	auto i = 0u;
+	for (; i + 8 <= n; i += 8) {
+		auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+		auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(a + i), _mm256_max_epi32(va, vb));
+	}
+	SIMDKernels::scalar::maxInto(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void orIntoAVX2(uint64_t *a, const uint64_t *b, unsigned int n)
+{
+	auto i = 0u;
+	for (; i + 4 <= n; i += 4) {
+		auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+		auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(a + i), _mm256_or_si256(va, vb));
+	}
+	SIMDKernels::scalar::orInto(a + i, b + i, n - i);
+}
+
+#endif /* GENMC_X86_KERNELS */
+
+/************************************************************
+ ** Dispatching
+ ***********************************************************/
+
+namespace {
+
+struct KernelTable {
+	const char *name;
+	unsigned int (*findFirstGreater)(const int *, const int *, unsigned int);
+	void (*maxInto)(int *, const int *, unsigned int);
+	void (*orInto)(uint64_t *, const uint64_t *, unsigned int);
+};
+
+KernelTable selectKernels()
+{
+#ifdef GENMC_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return {"avx2", findFirstGreaterAVX2, maxIntoAVX2, orIntoAVX2};
+	if (__builtin_cpu_supports("sse4.1"))
+		return {"sse4.1", findFirstGreaterSSE, maxIntoSSE, orIntoSSE};
+#endif
+	return {"scalar", SIMDKernels::scalar::findFirstGreater,
+		SIMDKernels::scalar::maxInto, SIMDKernels::scalar::orInto};
+}
+
+const KernelTable &getKernels()
+{
+	static const KernelTable kernels = selectKernels();
+	return kernels;
+}
+
+} /* namespace */
+
+unsigned int SIMDKernels::findFirstGreater(const int *a, const int *b, unsigned int n)
+{
+	return getKernels().findFirstGreater(a, b, n);
+}
+
+void SIMDKernels::maxInto(int *a, const int *b, unsigned int n)
+{
+	getKernels().maxInto(a, b, n);
+}
+
+void SIMDKernels::orInto(uint64_t *a, const uint64_t *b, unsigned int n)
+{
+	getKernels().orInto(a, b, n);
+}
+
+const char *SIMDKernels::getImplName()
+{
+	return getKernels().name;
+}
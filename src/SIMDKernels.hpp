@@ -0,0 +1,52 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __SIMD_KERNELS_HPP__
+#define __SIMD_KERNELS_HPP__
+
+#include <cstdint>
+
+/*
+ * Vectorized kernels for the hottest loops over vector clocks and
+ * relation matrices. The best implementation supported by the host
+ * (AVX2, SSE4.1, or plain scalar code) is chosen at runtime, the
+ * first time any of the kernels is used.
+ */
+namespace SIMDKernels {
+
+	/* Returns the first index i < N such that B[i] > A[i], or N if none */
+	unsigned int findFirstGreater(const int *a, const int *b, unsigned int n);
+
+	/* Sets A[i] = max(A[i], B[i]) for all i < N */
+	void maxInto(int *a, const int *b, unsigned int n);
+
+	/* Sets A[i] |= B[i] for all i < N */
+	void orInto(uint64_t *a, const uint64_t *b, unsigned int n);
+
+	/* Returns the name of the implementation in use */
+	const char *getImplName();
+
+	/* Scalar versions of the above (always available) */
+	namespace scalar {
+		unsigned int findFirstGreater(const int *a, const int *b, unsigned int n);
+		void maxInto(int *a, const int *b, unsigned int n);
+		void orInto(uint64_t *a, const uint64_t *b, unsigned int n);
+	}
+}
+
+#endif /* __SIMD_KERNELS_HPP__ */
@@ -5,6 +5,8 @@
 #include "SOCalculator.hpp"
 #include "ExecutionGraph.hpp"
 #include "GraphIterators.hpp"
+#include "TaskPool.hpp"
+#include <algorithm>
 #include <vector>
 
 SOCalculator::const_send_iterator
@@ -215,30 +217,82 @@ SOCalculator::getCoherentRevisits(const SendLabel *sLab)
 // 		      });
 // }
 
-// bool SOCalculator::coherenceSuccRemainInGraph(const BackwardRevisit &r)
-// {
-// 	auto &g = getGraph();
-// 	auto *sendLab = g.getSendLabel(r.getRev());
-// 	if (g.isRMWSend(sendLab))
-// 		return true;
+bool SOCalculator::sendOrderSuccRemainInGraph(const BackwardSRRevisit &r)
+{
+	auto &g = getGraph();
+	auto *sendLab = g.getSendLabel(r.getRev());
 
-// 	auto succIt = succ_begin(sendLab->getChannel(), sendLab->getPos());
-// 	auto succE = succ_end(sendLab->getChannel(), sendLab->getPos());
-// 	if (succIt == succE)
-// 		return true;
+	auto succIt = succ_begin(sendLab->getChannel(), sendLab->getPos());
+	auto succE = succ_end(sendLab->getChannel(), sendLab->getPos());
+	if (succIt == succE)
+		return true;
 
-// 	return g.getRevisitView(r)->contains(*succIt);
-// }
+	return g.getRevisitView(r)->contains(*succIt);
+}
 
 bool SOCalculator::wasAddedMaximally(const EventLabel *lab)
 {
 	if (auto *mLab = llvm::dyn_cast<ChannelAccessLabel>(lab))
 		return mLab->wasAddedMax();
+	if (auto *mLab = llvm::dyn_cast<MemAccessLabel>(lab))
+		return mLab->wasAddedMax();
 	if (auto *oLab = llvm::dyn_cast<OptionalLabel>(lab))
 		return !oLab->isExpanded();
 	return true;
 }
 
+bool SOCalculator::inMaximalPath(const BackwardSRRevisit &r)
+{
+	if (!sendOrderSuccRemainInGraph(r))
+		return false;
+
+	auto &g = getGraph();
+	auto v = g.getRevisitView(r);
+
+	for (const auto *lab : labels(g)) {
+		if ((lab->getPos() != r.getPos() && v->contains(lab->getPos())) ||
+		    g.isOptBlockedRead(lab))
+			continue;
+
+		if (g.hasBeenRevisitedByDeleted(r, lab))
+			return false;
+		if (!wasAddedMaximally(lab))
+			return false;
+	}
+	return true;
+}
+
+
+bool SOCalculator::collectStats = false;
+thread_local SOCalculator::ChannelStatsMap SOCalculator::chStats;
+
+SOCalculator::ChannelStatsMap SOCalculator::takeChannelStats()
+{
+	ChannelStatsMap result;
+
+	std::swap(result, chStats);
+	return result;
+}
+
+bool SOCalculator::hasOrderedSends(Channel ch) const
+{
+	const auto &g = getGraph();
+	const auto &chSends = getSendsToCh(ch);
+
+	if (chSends.size() <= 1)
+		return true;
+
+	auto producer = chSends[0].thread;
+	if (std::all_of(chSends.begin(), chSends.end(), [&](const Event &s)
+			{ return s.thread == producer; }))
+		return true;
+
+	for (auto i = 1u; i < chSends.size(); i++) {
+		if (!g.getEventLabel(chSends[i])->getHbView().contains(chSends[i - 1]))
+			return false;
+	}
+	return true;
+}
 
 void SOCalculator::initCalc()
 {
@@ -246,24 +300,49 @@ void SOCalculator::initCalc()
 	auto &coRelation = gm.getPerChRelation(ExecutionGraph::RelationId::so);
 
 	coRelation.clear();
+	concurrentChs.clear();
+	std::vector<GlobalRelation *> toClose;
 	for (auto chIt = begin(); chIt != end(); chIt++) {
 		coRelation[chIt->first] = GlobalRelation(getSendsToCh(chIt->first));
 		if (chIt->second.empty())
 			continue;
 		for (auto sIt = chIt->second.begin(); sIt != chIt->second.end() - 1; sIt++)
 			coRelation[chIt->first].addEdge(*sIt, *(sIt + 1));
-		coRelation[chIt->first].transClosure();
+
+		/* A totally ordered channel is just the chain above; only
+		 * concurrent producers need the closure */
+		if (hasOrderedSends(chIt->first))
+			continue;
+		concurrentChs.insert(chIt->first);
+		toClose.push_back(&coRelation[chIt->first]);
 	}
+	TaskPool::parallelFor(toClose.size(), [&](std::size_t i){ toClose[i]->transClosure(); });
 	return;
 }
 
+void SOCalculator::recordStats() const
+{
+	if (!collectStats)
+		return;
+
+	for (auto chIt = begin(); chIt != end(); chIt++) {
+		if (chIt->second.empty())
+			continue;
+		if (concurrentChs.count(chIt->first))
+			++chStats[chIt->first].closure;
+		else
+			++chStats[chIt->first].linear;
+	}
+}
+
 Calculator::CalculationResult SOCalculator::doCalc()
 {
 	auto &gm = getGraph();
 	auto &coRelation = gm.getPerChRelation(ExecutionGraph::RelationId::so);
 
 	for (auto chIt = begin(); chIt != end(); chIt++) {
-		if (!coRelation[chIt->first].isIrreflexive())
+		if (concurrentChs.count(chIt->first) &&
+		    !coRelation[chIt->first].isIrreflexive())
 			return Calculator::CalculationResult(false, false);
 	}
 	return Calculator::CalculationResult(false, true);
@@ -6,12 +6,16 @@
 #define __SO_CALCULATOR_HPP__
 
 #include "Calculator.hpp"
+#include "VSet.hpp"
 #include <llvm/ExecutionEngine/GenericValue.h>
 #include <llvm/Support/Casting.h>
 #include <llvm/Support/raw_ostream.h>
+#include <map>
 #include <vector>
 #include <unordered_map>
 
+class BackwardSRRevisit;
+
 /*******************************************************************************
  **                        SOCalculator Class
  ******************************************************************************/
@@ -37,6 +41,19 @@ public:
 	using reverse_send_iterator = SendList::reverse_iterator;
 	using const_reverse_send_iterator = SendList::const_reverse_iterator;
 
+	/* How often each consistency path was taken for a channel */
+	struct ChannelPathStats {
+		unsigned linear = 0;  /* sends totally ordered; FIFO scan only */
+		unsigned closure = 0; /* concurrent producers; so closure */
+
+		ChannelPathStats &operator+=(const ChannelPathStats &other) {
+			linear += other.linear;
+			closure += other.closure;
+			return *this;
+		}
+	};
+	using ChannelStatsMap = std::map<Channel, ChannelPathStats>;
+
 	/* Constructor */
 	SOCalculator(ExecutionGraph &g)
 		: Calculator(g) {}
@@ -137,9 +154,9 @@ public:
 	 std::vector<Event>
 	getCoherentRevisits(const SendLabel *wLab) ;
 
-	// /* Returns whether the path from RLAB to WLAB is maximal */
-	//  bool
-	// inMaximalPath(const BackwardRevisit &r) ;
+	/* Returns whether the path from the receive to the send of R is maximal */
+	bool
+	inMaximalPath(const BackwardSRRevisit &r);
 
 
 	/* Overrided Calculator methods */
@@ -148,6 +165,10 @@ public:
 
 	Calculator::CalculationResult doCalc() override;
 
+	bool isIndependent() const override { return true; }
+
+	void recordStats() const override;
+
 	/* Stops tracking all stores not included in "preds" in the graph */
 	void removeAfter(const VectorClock &preds) override;
 
@@ -155,6 +176,13 @@ public:
 		return std::make_unique<SOCalculator>(g);
 	}
 
+	/* Makes the calculators gather per-channel path statistics */
+	static void enableChannelStats() { collectStats = true; }
+
+	/* Returns (and resets) the per-channel path statistics gathered
+	 * so far by the calculators of this thread */
+	static ChannelStatsMap takeChannelStats();
+
 private:
 	/* Returns the offset for a particular send */
 	int getSendOffset(Channel ch, Event e) const;
@@ -173,7 +201,9 @@ private:
 	/* Returns the events that are mo^-1;rf?-after sLab */
 	std::vector<Event> getSOInvOptRfAfter(const SendLabel *sLab);
 
-	// bool coherenceSuccRemainInGraph(const BackwardRevisit &r);
+	/* Returns true if the so-successor of R's send (if any) is not
+	 * deleted by the revisit R */
+	bool sendOrderSuccRemainInGraph(const BackwardSRRevisit &r);
 
 	bool wasAddedMaximally(const EventLabel *lab);
 
@@ -183,6 +213,20 @@ private:
 
 	/* Returns true if the channel "ch" contains the event "e" */
 	bool chContains(Channel ch, Event e) const;
+
+	/* Whether the sends of "ch" are totally ordered, i.e., they all
+	 * come from one producer or form an hb-chain in send order. */
+	bool hasOrderedSends(Channel ch) const;
+
+	/* Channels whose sends are not totally ordered (as of initCalc()) */
+	VSet<Channel> concurrentChs;
+
+	/* Whether path statistics are gathered (-print-channel-stats) */
+	static bool collectStats;
+
+	/* Path statistics; calculators are cloned fresh for each graph
+	 * copy, so these are kept per thread and collected by the driver */
+	static thread_local ChannelStatsMap chStats;
 };
 
 #endif /* __SO_CALCULATOR_HPP__ */
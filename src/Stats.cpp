@@ -0,0 +1,197 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#include "Error.hpp"
+#include "Stats.hpp"
+#include <llvm/Support/Format.h>
+#include <algorithm>
+#include <sys/resource.h>
+
+bool Stats::enabled = false;
+thread_local Stats::Data Stats::local;
+thread_local unsigned int Stats::phaseDepth = 0;
+thread_local std::chrono::nanoseconds Stats::phaseTime(0);
+
+Stats::Data &Stats::Data::operator+=(const Data &other)
+{
+	for (auto i = 0u; i < phases.size(); i++)
+		phases[i] += other.phases[i];
+	executions += other.executions;
+	interpreterTime += other.interpreterTime;
+	for (auto &kv : other.calculators)
+		calculators[kv.first] += kv.second;
+	for (auto &kv : other.revisits)
+		revisits[kv.first] += kv.second;
+	for (auto &kv : other.incremental)
+		incremental[kv.first] += kv.second;
+	if (graphSizes.size() < other.graphSizes.size())
+		graphSizes.resize(other.graphSizes.size(), 0);
+	for (auto i = 0u; i < other.graphSizes.size(); i++)
+		graphSizes[i] += other.graphSizes[i];
+	peakGraphBytes = std::max(peakGraphBytes, other.peakGraphBytes);
+	instructions += other.instructions;
+	return *this;
+}
+
+Stats::Data Stats::takeLocal()
+{
+	Data result;
+
+	std::swap(result, local);
+	return result;
+}
+
+void Stats::recordGraph(unsigned int size, long long bytes)
+{
+	auto bucket = 0u;
+	while (size >> (bucket + 1))
+		++bucket;
+	if (local.graphSizes.size() <= bucket)
+		local.graphSizes.resize(bucket + 1, 0);
+	++local.graphSizes[bucket];
+	local.peakGraphBytes = std::max(local.peakGraphBytes, bytes);
+}
+
+const char *Stats::getPhaseName(Phase p)
+{
+	switch (p) {
+	case Phase::UpdateLabelViews:
+		return "updateLabelViews";
+	case Phase::GetRfsApproximation:
+		return "getRfsApproximation";
+	case Phase::CalcRevisits:
+		return "calcRevisits";
+	case Phase::CopyGraph:
+		return "copyGraph";
+	case Phase::IsConsistent:
+		return "isConsistent";
+	case Phase::RestrictGraph:
+		return "restrictGraph";
+	case Phase::Replay:
+		return "replay";
+	default:
+		BUG();
+	}
+}
+
+long Stats::getPeakRSS()
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage))
+		return 0;
+	return usage.ru_maxrss;
+}
+
+static double toMillis(std::chrono::nanoseconds t)
+{
+	return t.count() * 1e-6;
+}
+
+static std::string getKindName(Revisit::Kind k)
+{
+	std::string buf;
+	llvm::raw_string_ostream s(buf);
+
+	s << k;
+	return s.str();
+}
+
+void Stats::print(llvm::raw_ostream &s, const Data &d)
+{
+	auto printTiming = [&](const std::string &name, const Timing &t){
+		s << llvm::format("  %-24s %12llu calls %12.2f ms\n",
+				  name.c_str(), t.calls, toMillis(t.time));
+	};
+
+	s << "Phases:\n";
+	for (auto i = 0u; i < d.phases.size(); i++)
+		printTiming(getPhaseName(static_cast<Phase>(i)), d.phases[i]);
+	for (auto &kv : d.calculators)
+		printTiming("  " + kv.first, kv.second);
+
+	s << "Interpreter:\n";
+	printTiming("executions", d.executions);
+	printTiming("  outside phases", Timing{d.executions.calls, d.interpreterTime});
+
+	s << "Revisits:\n";
+	for (auto &kv : d.revisits)
+		s << llvm::format("  %-24s %12llu\n", getKindName(kv.first).c_str(), kv.second);
+
+	s << "Incremental checks:\n";
+	for (auto &kv : d.incremental)
+		s << llvm::format("  %-24s %12llu\n", kv.first.c_str(), kv.second);
+
+	s << "Graph sizes (events):\n";
+	for (auto i = 0u; i < d.graphSizes.size(); i++) {
+		if (d.graphSizes[i] == 0)
+			continue;
+		auto range = "[" + std::to_string(1ULL << i) + ", " +
+			std::to_string(1ULL << (i + 1)) + ")";
+		s << llvm::format("  %-24s %12llu\n", range.c_str(), d.graphSizes[i]);
+	}
+	s << "Interpreted instructions: " << d.instructions;
+	if (d.interpreterTime.count() > 0)
+		s << llvm::format(" (%.2f M/s in the interpreter)",
+				  d.instructions / toMillis(d.interpreterTime) / 1000);
+	s << "\n";
+	s << "Peak graph memory: " << d.peakGraphBytes << " bytes\n";
+	s << "Peak RSS: " << getPeakRSS() << " KB\n";
+}
+
+void Stats::printJSON(llvm::raw_ostream &s, const Data &d)
+{
+	auto printTiming = [&](const Timing &t){
+		s << "{\"calls\": " << t.calls << ", \"ms\": "
+		  << llvm::format("%.3f", toMillis(t.time)) << "}";
+	};
+
+	s << "{\n  \"phases\": {";
+	for (auto i = 0u; i < d.phases.size(); i++) {
+		s << (i ? "," : "") << "\n    \"" << getPhaseName(static_cast<Phase>(i)) << "\": ";
+		printTiming(d.phases[i]);
+	}
+	s << "\n  },\n  \"executions\": ";
+	printTiming(d.executions);
+	s << ",\n  \"interpreterMs\": " << llvm::format("%.3f", toMillis(d.interpreterTime));
+	s << ",\n  \"calculators\": {";
+	auto first = true;
+	for (auto &kv : d.calculators) {
+		s << (first ? "" : ",") << "\n    \"" << kv.first << "\": ";
+		printTiming(kv.second);
+		first = false;
+	}
+	s << "\n  },\n  \"revisits\": {";
+	first = true;
+	for (auto &kv : d.revisits) {
+		s << (first ? "" : ",") << "\n    \"" << getKindName(kv.first) << "\": " << kv.second;
+		first = false;
+	}
+	s << "\n  },\n  \"incremental\": {";
+	first = true;
+	for (auto &kv : d.incremental) {
+		s << (first ? "" : ",") << "\n    \"" << kv.first << "\": " << kv.second;
+		first = false;
+	}
+	s << "\n  },\n  \"graphSizes\": [";
+	for (auto i = 0u; i < d.graphSizes.size(); i++)
+		s << (i ? ", " : "") << d.graphSizes[i];
+	s << "],\n  \"instructions\": " << d.instructions
+	  << ",\n  \"peakGraphBytes\": " << d.peakGraphBytes
+	  << ",\n  \"peakRSSKB\": " << getPeakRSS() << "\n}\n";
+}
@@ -0,0 +1,249 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __STATS_HPP__
+#define __STATS_HPP__
+
+#include "Revisit.hpp"
+#include <llvm/Support/raw_ostream.h>
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+ **                             Stats Class
+ ******************************************************************************/
+
+/*
+ * Profiling counters for the exploration (-print-stats, -print-stats-json).
+ *
+ * Each thread gathers its own counters without synchronization; the
+ * drivers collect them into their results once they are done, and the
+ * results of all workers are summed up as usual. Unless enabled, a
+ * timer costs a single (predictable) branch. Defining GENMC_NO_STATS
+ * compiles all the counters out altogether.
+ */
+class Stats {
+
+public:
+	/* The phases of the exploration that are timed */
+	enum class Phase {
+		UpdateLabelViews,
+		GetRfsApproximation,
+		CalcRevisits,
+		CopyGraph,
+		IsConsistent,
+		RestrictGraph,
+		Replay,		/* Graph-driven replays of error traces */
+		NumPhases,
+	};
+
+	/* Time spent in (and number of calls to) some part of the code */
+	struct Timing {
+		unsigned long long calls = 0;
+		std::chrono::nanoseconds time = std::chrono::nanoseconds(0);
+
+		Timing &operator+=(const Timing &other) {
+			calls += other.calls;
+			time += other.time;
+			return *this;
+		}
+	};
+
+	/* All the counters of a thread (or, after merging, of a run) */
+	struct Data {
+		std::array<Timing, static_cast<unsigned>(Phase::NumPhases)> phases;
+
+		/* Whole runs of the program by the interpreter. This includes
+		 * the time of most phases, so it is not one of them */
+		Timing executions;
+
+		/* The part of the executions spent outside all timed phases,
+		 * i.e., running instructions in the interpreter */
+		std::chrono::nanoseconds interpreterTime = std::chrono::nanoseconds(0);
+
+		/* isConsistent(), split by the relation each calculator computes */
+		std::map<std::string, Timing> calculators;
+
+		/* Revisits performed, by kind */
+		std::map<Revisit::Kind, unsigned long long> revisits;
+
+		/* How often incremental computations could reuse earlier
+		 * results (e.g., the hb cache being extended or rebuilt) */
+		std::map<std::string, unsigned long long> incremental;
+
+		/* Entry i counts finished graphs with [2^i, 2^(i+1)) events */
+		std::vector<unsigned long long> graphSizes;
+
+		/* Highest label and view memory in use (by all workers) at the
+		 * end of an execution; merging takes the maximum, not the sum */
+		long long peakGraphBytes = 0;
+
+		/* Instructions run by the interpreter (error replays excluded) */
+		unsigned long long instructions = 0;
+
+		Data &operator+=(const Data &other);
+	};
+
+	/* Turns on the counters; has to be called before any worker starts */
+	static void enable() { enabled = true; }
+#ifdef GENMC_NO_STATS
+	static constexpr bool isEnabled() { return false; }
+#else
+	static bool isEnabled() { return enabled; }
+#endif
+
+	/* The counters of the calling thread */
+	static Data &getLocal() { return local; }
+
+	/* Returns (and resets) the counters of the calling thread */
+	static Data takeLocal();
+
+	static Timing &getPhase(Phase p) {
+		return local.phases[static_cast<unsigned>(p)];
+	}
+
+	/* Phases may nest: only the outermost ones count towards the
+	 * time the calling thread has spent in phases */
+	static void enterPhase() { ++phaseDepth; }
+	static void exitPhase(std::chrono::nanoseconds t) {
+		if (--phaseDepth == 0)
+			phaseTime += t;
+	}
+	static std::chrono::nanoseconds getPhaseTime() { return phaseTime; }
+
+	/* Records the completion of a graph with SIZE events that
+	 * leaves BYTES of label and view memory in use */
+	static void recordGraph(unsigned int size, long long bytes);
+
+	static void recordRevisit(Revisit::Kind k) { ++local.revisits[k]; }
+
+	static void recordIncremental(const char *what) { ++local.incremental[what]; }
+
+	static const char *getPhaseName(Phase p);
+
+	/* Peak resident set size of the process, in KB */
+	static long getPeakRSS();
+
+	/* Human-readable and JSON reports */
+	static void print(llvm::raw_ostream &s, const Data &d);
+	static void printJSON(llvm::raw_ostream &s, const Data &d);
+
+private:
+	static bool enabled;
+	static thread_local Data local;
+	static thread_local unsigned int phaseDepth;
+	static thread_local std::chrono::nanoseconds phaseTime;
+};
+
+
+/*******************************************************************************
+ **                           ScopedTimer Class
+ ******************************************************************************/
+
+/* Adds the time until the end of the scope to a timing (if stats are on) */
+class ScopedTimer {
+
+public:
+	explicit ScopedTimer(Stats::Phase p)
+		: ScopedTimer(Stats::isEnabled() ? &Stats::getPhase(p) : nullptr) {
+		phase = (timing != nullptr);
+		if (phase)
+			Stats::enterPhase();
+	}
+	explicit ScopedTimer(Stats::Timing *t) : timing(t) {
+		if (timing)
+			start = std::chrono::steady_clock::now();
+	}
+	ScopedTimer(const ScopedTimer &) = delete;
+
+	~ScopedTimer() {
+		if (!timing)
+			return;
+		auto t = std::chrono::steady_clock::now() - start;
+		timing->time += t;
+		++timing->calls;
+		if (phase)
+			Stats::exitPhase(t);
+	}
+
+private:
+	Stats::Timing *timing;
+	bool phase = false;
+	std::chrono::steady_clock::time_point start;
+};
+
+
+/*******************************************************************************
+ **                           ExecutionTimer Class
+ ******************************************************************************/
+
+/* Times a run of the program, along with the part of it that is not
+ * spent in any timed phase (if stats are on) */
+class ExecutionTimer {
+
+public:
+	ExecutionTimer() : enabled(Stats::isEnabled()) {
+		if (!enabled)
+			return;
+		start = std::chrono::steady_clock::now();
+		phasesAtStart = Stats::getPhaseTime();
+	}
+	ExecutionTimer(const ExecutionTimer &) = delete;
+
+	~ExecutionTimer() {
+		if (!enabled)
+			return;
+		auto t = std::chrono::steady_clock::now() - start;
+		auto &d = Stats::getLocal();
+		d.executions.time += t;
+		++d.executions.calls;
+		d.interpreterTime += t - (Stats::getPhaseTime() - phasesAtStart);
+	}
+
+private:
+	bool enabled;
+	std::chrono::steady_clock::time_point start;
+	std::chrono::nanoseconds phasesAtStart;
+};
+
+#ifdef GENMC_NO_STATS
+# define GENMC_TIME_PHASE(p) do {} while (0)
+# define GENMC_TIME_EXECUTION() do {} while (0)
+# define GENMC_TIME_CALC(t) do {} while (0)
+# define GENMC_COUNT_REVISIT(k) do {} while (0)
+# define GENMC_COUNT_INCREMENTAL(what) do {} while (0)
+#else
+# define GENMC_TIME_PHASE(p) ScopedTimer phaseTimer__(Stats::Phase::p)
+# define GENMC_TIME_EXECUTION() ExecutionTimer executionTimer__
+# define GENMC_TIME_CALC(t) ScopedTimer calcTimer__(t)
+# define GENMC_COUNT_REVISIT(k)					\
+	do {							\
+		if (Stats::isEnabled())				\
+			Stats::recordRevisit(k);		\
+	} while (0)
+# define GENMC_COUNT_INCREMENTAL(what)				\
+	do {							\
+		if (Stats::isEnabled())				\
+			Stats::recordIncremental(what);		\
+	} while (0)
+#endif
+
+#endif /* __STATS_HPP__ */
@@ -0,0 +1,101 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#include "TaskPool.hpp"
+
+TaskPool &TaskPool::get()
+{
+	static TaskPool pool;
+	return pool;
+}
+
+void TaskPool::start(unsigned int n)
+{
+	auto &pool = get();
+	if (!pool.workers_.empty())
+		return;
+	for (auto i = 0u; i < n; i++)
+		pool.workers_.emplace_back([&pool]{ pool.runWorker(); });
+}
+
+TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(qMutex_);
+		stop_ = true;
+	}
+	qCV_.notify_all();
+	for (auto &w : workers_)
+		w.join();
+}
+
+void TaskPool::Loop::work()
+{
+	std::size_t i;
+	while ((i = next.fetch_add(1, std::memory_order_relaxed)) < size) {
+		fun(i);
+		if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == size) {
+			std::lock_guard<std::mutex> lock(doneMutex);
+			doneCV.notify_all();
+		}
+	}
+}
+
+void TaskPool::runWorker()
+{
+	while (true) {
+		std::shared_ptr<Loop> loop;
+		{
+			std::unique_lock<std::mutex> lock(qMutex_);
+			qCV_.wait(lock, [&]{ return stop_ || !queue_.empty(); });
+			if (stop_)
+				return;
+			loop = std::move(queue_.front());
+			queue_.pop_front();
+		}
+		loop->work();
+	}
+}
+
+void TaskPool::parallelFor(std::size_t n, const std::function<void(std::size_t)> &fun)
+{
+	auto &pool = get();
+	if (pool.workers_.empty() || n <= 1) {
+		for (auto i = 0u; i < n; i++)
+			fun(i);
+		return;
+	}
+
+	/* Invite as many helpers as there are iterations left for them */
+	auto loop = std::make_shared<Loop>(n, fun);
+	auto helpers = std::min(pool.workers_.size(), n - 1);
+	{
+		std::lock_guard<std::mutex> lock(pool.qMutex_);
+		for (auto i = 0u; i < helpers; i++)
+			pool.queue_.push_back(loop);
+	}
+	if (helpers == 1)
+		pool.qCV_.notify_one();
+	else
+		pool.qCV_.notify_all();
+
+	loop->work();
+
+	std::unique_lock<std::mutex> lock(loop->doneMutex);
+	loop->doneCV.wait(lock, [&]{ return loop->done.load(std::memory_order_acquire) == n; });
+}
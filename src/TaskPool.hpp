@@ -0,0 +1,93 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __TASK_POOL_HPP__
+#define __TASK_POOL_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*******************************************************************************
+ **                           TaskPool Class
+ ******************************************************************************/
+
+/*
+ * A small process-wide pool used to split a single consistency check
+ * across cores (as opposed to ThreadPool, which runs whole explorations).
+ * The calling thread always takes part in the loops it submits, so
+ * loops may be nested (e.g., a calculator running on a worker can issue
+ * its own per-location loop) without deadlocking.
+ */
+class TaskPool {
+
+public:
+	/* Starts N helper threads (in addition to the callers). Subsequent
+	 * calls are ignored; 0 keeps everything sequential */
+	static void start(unsigned int n);
+
+	/* Whether loops are actually split across threads */
+	static bool isEnabled() { return get().workers_.size() > 0; }
+
+	/* Calls FUN(i) for all i in [0, N), possibly concurrently, and
+	 * returns once all calls have completed */
+	static void parallelFor(std::size_t n, const std::function<void(std::size_t)> &fun);
+
+	~TaskPool();
+
+private:
+	/* A loop shared by the caller and the helpers that picked it up */
+	struct Loop {
+		Loop(std::size_t n, const std::function<void(std::size_t)> &f)
+			: size(n), fun(f), next(0), done(0) {}
+
+		/* Runs iterations until none are left to claim */
+		void work();
+
+		const std::size_t size;
+		const std::function<void(std::size_t)> &fun;
+		std::atomic<std::size_t> next;
+		std::atomic<std::size_t> done;
+
+		std::mutex doneMutex;
+		std::condition_variable doneCV;
+	};
+
+	TaskPool() = default;
+
+	static TaskPool &get();
+
+	void runWorker();
+
+	/* One entry per helper invited to a loop */
+	std::deque<std::shared_ptr<Loop> > queue_;
+	std::mutex qMutex_;
+	std::condition_variable qCV_;
+	bool stop_ = false;
+
+	std::vector<std::thread> workers_;
+};
+
+#endif /* __TASK_POOL_HPP__ */
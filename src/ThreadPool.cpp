@@ -19,6 +19,11 @@
  */
 
 #include "ThreadPool.hpp"
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+
+thread_local unsigned int ThreadPool::index_ = -1U;
 
 void ThreadPool::addWorker(unsigned int i, std::unique_ptr<GenMCDriver> d)
 {
@@ -26,17 +31,27 @@ void ThreadPool::addWorker(unsigned int i, std::unique_ptr<GenMCDriver> d)
 		GenMCDriver::Result(unsigned int, std::unique_ptr<GenMCDriver> driver)>;
 
 	ThreadT t([this](unsigned int i, std::unique_ptr<GenMCDriver> driver){
+		setIndex(i);
+		auto &stats = stats_[i];
 		while (true) {
+			auto idleStart = std::chrono::steady_clock::now();
 			auto state = popTask();
+			auto busyStart = std::chrono::steady_clock::now();
+			stats.idleTime += busyStart - idleStart;
 
 			/* If the state is empty, nothing left to do */
 			if (!state)
 				break;
 
 			/* Prepare the driver and start the exploration */
+			auto span = state->span;
 			driver->setSharedState(std::move(state));
 			driver->run();
 
+			auto busyTime = std::chrono::steady_clock::now() - busyStart;
+			stats.busyTime += busyTime;
+			recordTaskTime(busyTime, span);
+
 			/* If that was the last task, notify everyone */
 			if (decRemainingTasks() == 0) {
 				halt();
@@ -55,13 +70,25 @@ void ThreadPool::addWorker(unsigned int i, std::unique_ptr<GenMCDriver> d)
 
 void ThreadPool::submit(std::unique_ptr<TaskT> t)
 {
-	std::lock_guard<std::mutex> lock(stateMtx_);
 	incRemainingTasks();
-	queue_.push(std::move(t));
-	stateCV_.notify_one();
+
+	/* Workers use their own deque; only the initial seeding goes global */
+	if (isWorkerThread())
+		localQueues_[getIndex()]->push(std::move(t));
+	else
+		queue_.push(std::move(t));
+
+	idleEC_.notifyOne();
 	return;
 }
 
+std::unique_ptr<ThreadPool::TaskT> ThreadPool::tryPopLocalQueue()
+{
+	if (!isWorkerThread())
+		return nullptr;
+	return localQueues_[getIndex()]->tryPop();
+}
+
 std::unique_ptr<ThreadPool::TaskT> ThreadPool::tryPopPoolQueue()
 {
 	return queue_.tryPop();
@@ -69,31 +96,144 @@ std::unique_ptr<ThreadPool::TaskT> ThreadPool::tryPopPoolQueue()
 
 std::unique_ptr<ThreadPool::TaskT> ThreadPool::tryStealOtherQueue()
 {
-	/* TODO: Implement work-stealing */
+	auto n = localQueues_.size();
+	auto self = isWorkerThread() ? getIndex() : 0;
+
+	/* Visit the victims round-robin, starting from our neighbour */
+	for (auto i = 1u; i <= n; i++) {
+		auto victim = (self + i) % n;
+		if (isWorkerThread() && victim == self)
+			continue;
+
+		auto &q = localQueues_[victim];
+		while (!q->empty()) {
+			if (auto t = q->trySteal())
+				return t;
+		}
+	}
 	return nullptr;
 }
 
+bool ThreadPool::allQueuesEmpty()
+{
+	if (!queue_.empty())
+		return false;
+	return std::all_of(localQueues_.begin(), localQueues_.end(),
+			   [](const std::unique_ptr<LocalQueueT> &q){ return q->empty(); });
+}
+
 std::unique_ptr<ThreadPool::TaskT> ThreadPool::popTask()
 {
 	while (true) {
-		if (auto t = tryPopPoolQueue())
+		if (auto t = tryPopLocalQueue())
+			return t;
+		else if (auto t = tryPopPoolQueue())
 			return t;
 		else if (auto t = tryStealOtherQueue())
 			return t;
 
-		if (shouldHalt() || getRemainingTasks() == 0)
+		if (!shouldKeepLooking())
 			return nullptr;
 
-		std::unique_lock<std::mutex> lock(stateMtx_);
-		stateCV_.wait(lock);
+		parkWorker([this]{ return allQueuesEmpty() && shouldKeepLooking(); });
 	}
 	return nullptr;
 }
 
+/* Weight of the latest sample in the running averages */
+static constexpr double avgWeight = 0.125;
+
+static void updateAverage(std::atomic<double> &avg, double sample)
+{
+	/* Lost updates are fine; this is only a heuristic */
+	auto old = avg.load(std::memory_order_relaxed);
+	avg.store(old == 0 ? sample : old + avgWeight * (sample - old),
+		  std::memory_order_relaxed);
+}
+
+void ThreadPool::recordTaskTime(std::chrono::nanoseconds time, unsigned int span)
+{
+	updateAverage(avgTaskTime_, time.count());
+	if (span)
+		updateAverage(avgEventTime_, double(time.count()) / span);
+}
+
+bool ThreadPool::shouldSplit(unsigned int depth, unsigned int span,
+			     std::chrono::nanoseconds copyTime)
+{
+	auto pending = getRemainingTasks();
+
+	switch (splitPolicy_) {
+	case SplitPolicy::fixed:
+		return pending < 8 * size();
+	case SplitPolicy::depth:
+		return depth < maxSplitDepth_;
+	case SplitPolicy::adaptive: {
+		/* Do not flood the queues, no matter what */
+		if (pending >= 8 * size())
+			return false;
+
+		/* Bootstrap until we have some measurements */
+		auto eventTime = avgEventTime_.load(std::memory_order_relaxed);
+		if (eventTime == 0)
+			return true;
+
+		/* Tasks that are not worth their state copy stay local,
+		 * while big tasks are split so that they do not starve others */
+		auto estimate = eventTime * span;
+		if (estimate < 4 * copyTime.count())
+			return false;
+		return pending < size() ||
+			estimate > 2 * avgTaskTime_.load(std::memory_order_relaxed);
+	}
+	default:
+		BUG();
+	}
+}
+
+template<typename F>
+void ThreadPool::parkWorker(F&& check)
+{
+	auto key = idleEC_.prepareWait();
+
+	/* Re-check after announcing, so that no notification is missed */
+	if (!check()) {
+		idleEC_.cancelWait();
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	idleEC_.commitWait(key);
+	auto &stats = stats_[getIndex()];
+	++stats.wakeUps;
+	stats.parkTime += std::chrono::steady_clock::now() - start;
+}
+
 std::vector<std::future<GenMCDriver::Result>> ThreadPool::waitForTasks()
 {
-	while (!shouldHalt() && getRemainingTasks())
-		std::this_thread::yield();
+	while (shouldKeepLooking()) {
+		auto key = doneEC_.prepareWait();
+		if (!shouldKeepLooking()) {
+			doneEC_.cancelWait();
+			break;
+		}
+		doneEC_.commitWait(key);
+	}
 
 	return std::move(results_);
 }
+
+void ThreadPool::printWorkerStats(llvm::raw_ostream &s) const
+{
+	auto toSecs = [](std::chrono::nanoseconds t){
+		return std::chrono::duration_cast<std::chrono::milliseconds>(t).count() * 1e-3;
+	};
+
+	for (auto i = 0u; i < stats_.size(); i++) {
+		s << "Worker " << i << ": "
+		  << llvm::format("%.2f", toSecs(stats_[i].busyTime)) << "s busy, "
+		  << llvm::format("%.2f", toSecs(stats_[i].idleTime)) << "s idle ("
+		  << llvm::format("%.2f", toSecs(stats_[i].parkTime)) << "s parked, "
+		  << stats_[i].wakeUps << " wake-ups)\n";
+	}
+}
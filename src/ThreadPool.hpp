@@ -30,7 +30,11 @@
 #include <llvm/Transforms/Utils/Cloning.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <future>
 
@@ -85,6 +89,228 @@ private:
 };
 
 
+/*******************************************************************************
+ **                           WorkStealingQueue Class
+ ******************************************************************************/
+
+/*
+ * A per-worker Chase-Lev deque (see Le et al., PPoPP'13, for the C11 version).
+ * The owner pushes and pops items at the bottom (LIFO), while other workers
+ * steal items from the top (FIFO). Only the owner may call push() and tryPop().
+ */
+class WorkStealingQueue {
+
+protected:
+	typedef GenMCDriver::SharedState QueueItemT;
+
+	/* A circular buffer whose capacity is a power of two */
+	class CircularArray {
+
+	public:
+		explicit CircularArray(int64_t logCap)
+			: cap(int64_t(1) << logCap), mask(cap - 1),
+			  items(new std::atomic<QueueItemT *>[cap]) {}
+
+		int64_t capacity() const { return cap; }
+
+		QueueItemT *get(int64_t i) const {
+			return items[i & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t i, QueueItemT *item) {
+			items[i & mask].store(item, std::memory_order_relaxed);
+		}
+
+		/* Returns a copy of this array with double the capacity,
+		 * containing the items in [t, b) */
+		std::unique_ptr<CircularArray> grow(int64_t b, int64_t t) const {
+			auto logCap = 1;
+			while ((int64_t(1) << logCap) <= cap)
+				++logCap;
+			auto na = std::make_unique<CircularArray>(logCap);
+			for (auto i = t; i < b; i++)
+				na->put(i, get(i));
+			return na;
+		}
+
+	private:
+		int64_t cap;
+		int64_t mask;
+		std::unique_ptr<std::atomic<QueueItemT *>[]> items;
+	};
+
+public:
+	/*** Constructors ***/
+
+	WorkStealingQueue() : top(0), bottom(0) {
+		arrays.push_back(std::make_unique<CircularArray>(5));
+		array.store(arrays.back().get(), std::memory_order_relaxed);
+	}
+	WorkStealingQueue(const WorkStealingQueue &) = delete;
+
+	/*** Queue operations ***/
+
+	/* Returns true if the queue seems empty (may be stale) */
+	bool empty() const {
+		auto b = bottom.load(std::memory_order_relaxed);
+		auto t = top.load(std::memory_order_relaxed);
+		return b <= t;
+	}
+
+	/* Adds a new item at the bottom of the queue (owner only) */
+	void push(std::unique_ptr<QueueItemT> item) {
+		auto b = bottom.load(std::memory_order_relaxed);
+		auto t = top.load(std::memory_order_acquire);
+		auto *a = array.load(std::memory_order_relaxed);
+		if (b - t > a->capacity() - 1) {
+			/* Old arrays are kept around, as thieves may still read them */
+			arrays.push_back(a->grow(b, t));
+			a = arrays.back().get();
+			array.store(a, std::memory_order_release);
+		}
+		a->put(b, item.release());
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	/* Tries to pop an item from the bottom of the queue (owner only) */
+	std::unique_ptr<QueueItemT> tryPop() {
+		auto b = bottom.load(std::memory_order_relaxed) - 1;
+		auto *a = array.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto t = top.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		auto *item = a->get(b);
+		if (t == b) {
+			/* Last item: race against thieves */
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+							 std::memory_order_relaxed))
+				item = nullptr;
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return std::unique_ptr<QueueItemT>(item);
+	}
+
+	/* Tries to steal an item from the top of the queue. Returns nullptr
+	 * if the queue is empty or if another thread won the race */
+	std::unique_ptr<QueueItemT> trySteal() {
+		auto t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return nullptr;
+
+		auto *a = array.load(std::memory_order_acquire);
+		auto *item = a->get(t);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+						 std::memory_order_relaxed))
+			return nullptr;
+		return std::unique_ptr<QueueItemT>(item);
+	}
+
+	/*** Destructor ***/
+
+	~WorkStealingQueue() {
+		while (tryPop())
+			;
+	}
+
+private:
+	/* Index of the next item to be stolen */
+	std::atomic<int64_t> top;
+
+	/* Index of the next free slot for the owner */
+	std::atomic<int64_t> bottom;
+
+	/* The array currently in use */
+	std::atomic<CircularArray *> array;
+
+	/* All arrays ever allocated (owner only) */
+	std::vector<std::unique_ptr<CircularArray> > arrays;
+};
+
+
+/*******************************************************************************
+ **                             EventCount Class
+ ******************************************************************************/
+
+/*
+ * An eventcount for parking threads until some condition becomes true.
+ * A waiter first calls prepareWait(), then re-checks its condition, and then
+ * either calls cancelWait() or commitWait() with the obtained key.
+ * Notifications are cheap when nobody waits (no lock is acquired), and
+ * notifyOne() wakes up a single waiter.
+ */
+class EventCount {
+
+public:
+	typedef uint64_t Key;
+
+	/*** Constructors ***/
+
+	EventCount() : epoch(0), waiters(0) {}
+	EventCount(const EventCount &) = delete;
+
+	/*** Waiting ***/
+
+	/* Announces that the calling thread is about to wait */
+	Key prepareWait() {
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		return epoch.load(std::memory_order_seq_cst);
+	}
+
+	/* Withdraws an announcement made with prepareWait() */
+	void cancelWait() {
+		waiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	/* Blocks until a notification after prepareWait() has returned KEY */
+	void commitWait(Key key) {
+		std::unique_lock<std::mutex> lock(mtx);
+		while (epoch.load(std::memory_order_seq_cst) == key)
+			cv.wait(lock);
+		waiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	/*** Notifications ***/
+
+	/* Wakes up (at most) one waiting thread */
+	void notifyOne() {
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_seq_cst) == 0)
+			return;
+		std::lock_guard<std::mutex> lock(mtx);
+		cv.notify_one();
+	}
+
+	/* Wakes up all waiting threads */
+	void notifyAll() {
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_seq_cst) == 0)
+			return;
+		std::lock_guard<std::mutex> lock(mtx);
+		cv.notify_all();
+	}
+
+private:
+	/* Incremented by each notification */
+	std::atomic<Key> epoch;
+
+	/* Number of threads between prepareWait() and the end of the wait */
+	std::atomic<unsigned> waiters;
+
+	/* Used only for the slow path (when there are waiters) */
+	std::mutex mtx;
+	std::condition_variable cv;
+};
+
+
 /*******************************************************************************
  **                           ThreadJoiner Class
  ******************************************************************************/
@@ -126,18 +352,42 @@ class ThreadPool {
 public:
 	typedef GenMCDriver::SharedState TaskT;
 	typedef GlobalWorkQueue GlobalQueueT;
+	typedef WorkStealingQueue LocalQueueT;
+
+	/* Idleness statistics of a worker (only written by the worker itself) */
+	struct alignas(64) WorkerStats {
+		/* Number of times the worker was woken up after parking */
+		unsigned long wakeUps = 0;
+
+		/* Total time the worker spent parked */
+		std::chrono::nanoseconds parkTime = std::chrono::nanoseconds(0);
+
+		/* Total time the worker spent executing tasks */
+		std::chrono::nanoseconds busyTime = std::chrono::nanoseconds(0);
+
+		/* Total time the worker spent looking for (or waiting on) tasks */
+		std::chrono::nanoseconds idleTime = std::chrono::nanoseconds(0);
+	};
 
 	/*** Constructors ***/
 
 	ThreadPool(const std::shared_ptr<const Config> conf,
 		   const std::unique_ptr<llvm::Module> &mod,
 		   const std::unique_ptr<ModuleInfo> &MI)
-		: numWorkers_(conf->threads), pinner_(numWorkers_), joiner_(workers_) {
+		: numWorkers_(conf->threads), splitPolicy_(conf->splitPolicy),
+		  maxSplitDepth_(conf->splitDepth), pinner_(numWorkers_), joiner_(workers_) {
 		numWorkers_ = conf->threads;
 
 		/* Set global variables before spawning the threads */
 		shouldHalt_.store(false);
 		remainingTasks_.store(0);
+		avgTaskTime_.store(0);
+		avgEventTime_.store(0);
+
+		/* All deques need to exist before any worker starts stealing */
+		for (auto i = 0u; i < numWorkers_; i++)
+			localQueues_.push_back(std::make_unique<LocalQueueT>());
+		stats_.resize(numWorkers_);
 
 		for (auto i = 0u; i < numWorkers_; i++) {
 			contexts_.push_back(std::make_unique<llvm::LLVMContext>());
@@ -169,6 +419,9 @@ public:
 	/* Sets the index of the calling thread */
 	void setIndex(unsigned int i) { index_ = i; }
 
+	/* Whether the calling thread is one of the pool's workers */
+	bool isWorkerThread() const { return index_ < localQueues_.size(); }
+
 	/*** Tasks-related ***/
 
 	/* Submits a task to be executed by a worker */
@@ -181,16 +434,29 @@ public:
 
 	bool shouldHalt() const { return shouldHalt_.load(); }
 
+	/* Returns true if a revisit at DEPTH that dropped SPAN stamps and
+	 * whose state took COPYTIME to create should be submitted to the
+	 * pool, instead of being explored by the calling worker */
+	bool shouldSplit(unsigned int depth, unsigned int span,
+			 std::chrono::nanoseconds copyTime);
+
 	/* Stops all threads */
 	void halt() {
-		std::lock_guard<std::mutex> lock(stateMtx_);
 		shouldHalt_.store(true);
-		stateCV_.notify_all();
+		idleEC_.notifyAll();
+		doneEC_.notifyAll();
 	}
 
 	/* Waits for all tasks to complete */
 	std::vector<std::future<GenMCDriver::Result>> waitForTasks();
 
+	/* Returns the idleness statistics of each worker.
+	 * Should only be called after waitForTasks() */
+	const std::vector<WorkerStats> &getWorkerStats() const { return stats_; }
+
+	/* Prints the idleness statistics of each worker */
+	void printWorkerStats(llvm::raw_ostream &s) const;
+
 	/*** Destructor ***/
 
 	~ThreadPool() { halt(); }
@@ -199,6 +465,9 @@ private:
 	/* Adds a worker thread to the pool */
 	void addWorker(unsigned int index, std::unique_ptr<GenMCDriver> driver);
 
+	/* Tries to pop a task from the calling worker's deque */
+	std::unique_ptr<TaskT> tryPopLocalQueue();
+
 	/* Tries to pop a task from the global queue */
 	std::unique_ptr<TaskT> tryPopPoolQueue();
 
@@ -208,6 +477,9 @@ private:
 	/* Pops the next task to be executed by a thread */
 	std::unique_ptr<TaskT> popTask();
 
+	/* Returns true if there is no task in any queue (may be stale) */
+	bool allQueuesEmpty();
+
 	std::vector<std::unique_ptr<llvm::LLVMContext>> contexts_;
 
 	/* Result of each thread */
@@ -219,22 +491,49 @@ private:
 	/* The number of workers the pool should reach */
 	unsigned int numWorkers_;
 
+	/* When to split revisits into new tasks */
+	SplitPolicy splitPolicy_;
+	unsigned int maxSplitDepth_;
+
+	/* Running averages (in ns) of the time a task takes,
+	 * and of the time a task takes per dropped stamp */
+	std::atomic<double> avgTaskTime_;
+	std::atomic<double> avgEventTime_;
+
 	/* The worker threads */
 	std::vector<std::thread> workers_;
 
-	/* A queue where tasks are stored */
+	/* A queue used for the initial seeding of the pool */
 	GlobalQueueT queue_;
 
+	/* Per-worker deques where workers submit their own tasks */
+	std::vector<std::unique_ptr<LocalQueueT>> localQueues_;
+
 	/* Number of tasks that need to be executed across threads */
 	std::atomic<unsigned> remainingTasks_;
 
 	/* The index of a worker thread */
 	static thread_local unsigned int index_;
 
-	/* Mutex+CV to determine whether the pool state has changed:
-	 * a new task has been submitted or all tasks have been completed */
-	std::mutex stateMtx_;
-	std::condition_variable stateCV_;
+	/* Whether the calling worker has to keep looking for tasks */
+	bool shouldKeepLooking() { return !shouldHalt() && getRemainingTasks(); }
+
+	/* Updates the running averages of task execution times */
+	void recordTaskTime(std::chrono::nanoseconds time, unsigned int span);
+
+	/* Parks the calling worker until a new task is submitted (or the
+	 * pool halts), unless CHECK tells that waiting is unnecessary */
+	template<typename F>
+	void parkWorker(F&& check);
+
+	/* Idle workers park here: notified when a task is submitted */
+	EventCount idleEC_;
+
+	/* The thread waiting for the pool parks here: notified on halt */
+	EventCount doneEC_;
+
+	/* Per-worker idleness statistics */
+	std::vector<WorkerStats> stats_;
 
 	ThreadPinner pinner_;
 
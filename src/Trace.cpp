@@ -0,0 +1,57 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#include "Error.hpp"
+#include "InterpreterEnumAPI.hpp"
+#include "Revisit.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+void TraceBuffer::print(llvm::raw_ostream &s) const
+{
+	if (!isEnabled())
+		return;
+
+	auto kept = std::min<unsigned long long>(recorded, entries.size());
+	s << "Trace (last " << kept << " of " << recorded << " entries):\n";
+	for (auto i = recorded - kept; i < recorded; i++) {
+		auto &e = entries[i % entries.size()];
+
+		s << "\t";
+		switch (e.kind) {
+		case Kind::ChannelOpen:
+			s << "open ch" << e.ch << " @ " << e.pos;
+			break;
+		case Kind::Send:
+			s << "send ch" << e.ch << " <- " << e.val << " @ " << e.pos;
+			break;
+		case Kind::Receive:
+			s << "receive ch" << e.ch << " @ " << e.pos << " rf " << e.other;
+			break;
+		case Kind::Revisit:
+			s << "revisit (" << static_cast<Revisit::Kind>(e.sub) << ") " << e.pos;
+			break;
+		case Kind::Block:
+			s << "block (" << static_cast<BlockageType>(e.sub) << ") " << e.pos;
+			break;
+		default:
+			BUG();
+		}
+		s << "\n";
+	}
+}
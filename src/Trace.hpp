@@ -0,0 +1,92 @@
+/*
+ * GenMC -- Generic Model Checking.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you can access it online at
+ * http://www.gnu.org/licenses/gpl-3.0.html.
+ */
+
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include "Event.hpp"
+#include <llvm/Support/raw_ostream.h>
+#include <cstdint>
+#include <vector>
+
+/*******************************************************************************
+ **                           TraceBuffer Class
+ ******************************************************************************/
+
+/*
+ * A fixed-size ring of binary trace entries (-trace-size). Each driver
+ * owns one, so recording needs no synchronization, and only the last
+ * entries are kept. Nothing is formatted until the buffer is printed.
+ * A disabled buffer costs a single branch per trace point, and
+ * defining GENMC_NO_TRACE compiles the trace points out altogether.
+ */
+class TraceBuffer {
+
+public:
+	enum class Kind : std::uint8_t {
+		ChannelOpen,
+		Send,
+		Receive,
+		Revisit,
+		Block,
+	};
+
+	/* CH and VAL are only meaningful for channel operations; SUB
+	 * holds the revisit kind or the blockage type, if any */
+	struct Entry {
+		Kind kind;
+		std::uint8_t sub;
+		int ch;
+		int val;
+		Event pos;
+		Event other;
+	};
+
+	/* A buffer of capacity 0 is disabled */
+	explicit TraceBuffer(unsigned int capacity = 0) : entries(capacity) {}
+
+	bool isEnabled() const { return !entries.empty(); }
+
+	/* Number of entries recorded so far (including overwritten ones) */
+	unsigned long long getNumRecorded() const { return recorded; }
+
+	void record(Kind k, Event pos, int ch = -1, int val = 0,
+		    Event other = Event::getInitializer(), std::uint8_t sub = 0) {
+		entries[recorded++ % entries.size()] = {k, sub, ch, val, pos, other};
+	}
+
+	void clear() { recorded = 0; }
+
+	/* Prints the entries kept, oldest first */
+	void print(llvm::raw_ostream &s) const;
+
+private:
+	std::vector<Entry> entries;
+	unsigned long long recorded = 0;
+};
+
+#ifdef GENMC_NO_TRACE
+# define GENMC_TRACE(buf, ...) do {} while (0)
+#else
+# define GENMC_TRACE(buf, ...) do {			\
+	if ((buf).isEnabled())				\
+		(buf).record(__VA_ARGS__);		\
+	} while (0)
+#endif
+
+#endif /* __TRACE_HPP__ */
@@ -20,16 +20,83 @@
 
 #include "Error.hpp"
 #include "View.hpp"
+#include "SIMDKernels.hpp"
+#include <atomic>
+#include <new>
+
+/* Heap storage used by all views. Storage might be released by a
+ * different thread than the one that allocated it (graph copies are
+ * handed to other threads), so the counter is shared (only views too
+ * large to be stored inline touch it) */
+static std::atomic<long long> heapBytesInUse(0);
+
+long long View::getHeapBytesInUse()
+{
+	return heapBytesInUse.load(std::memory_order_relaxed);
+}
+
+View::Rep *View::createRep(unsigned int cap, const int *old, unsigned int size)
+{
+	auto bytes = sizeof(Rep) + cap * sizeof(int);
+	auto *rep = static_cast<Rep *>(::operator new(bytes));
+	rep->capacity = cap;
+	std::copy(old, old + size, rep->data());
+	heapBytesInUse.fetch_add(bytes, std::memory_order_relaxed);
+	return rep;
+}
+
+void View::releaseRep(Rep *rep)
+{
+	if (!rep)
+		return;
+
+	heapBytesInUse.fetch_sub(sizeof(Rep) + rep->capacity * sizeof(int),
+				 std::memory_order_relaxed);
+	::operator delete(rep);
+}
+
+void View::grow(unsigned int size)
+{
+	if (size <= size_)
+		return;
+
+	auto cap = rep_ ? rep_->capacity : (unsigned int) inlineSize;
+	if (size > cap) {
+		auto *rep = createRep(std::max(size, 2 * size_), data(), size_);
+		releaseRep(rep_);
+		rep_ = rep;
+	}
+	std::fill(data() + size_, data() + size, 0);
+	size_ = size;
+}
 
 View& View::update(const View &v)
 {
 	if (v.empty())
 		return *this;
 
-	auto size = std::max(this->size(), v.size());
-	for (auto i = 0u; i < size; i++)
-		if ((*this)[i] < v[i])
-			(*this)[i] = v[i];
+	/* Only touch the storage if something changes. Inline views
+	 * are too small to benefit from the vectorized kernels */
+	auto common = std::min(size(), v.size());
+	auto i = 0u;
+	if (common > inlineSize) {
+		i = SIMDKernels::findFirstGreater(data(), v.data(), common);
+	} else {
+		while (i < common && get(i) >= v.get(i))
+			++i;
+	}
+	if (i == common && v.size() <= size())
+		return *this;
+
+	grow(v.size());
+	auto *d = data();
+	if (v.size() - i > inlineSize) {
+		SIMDKernels::maxInto(d + i, v.data() + i, v.size() - i);
+	} else {
+		for (; i < v.size(); i++)
+			if (d[i] < v.get(i))
+				d[i] = v.get(i);
+	}
 	return *this;
 }
 
@@ -24,7 +24,6 @@
 #include "Error.hpp"
 #include "Event.hpp"
 #include "VectorClock.hpp"
-#include <llvm/ADT/IndexedMap.h>
 #include <llvm/Support/raw_ostream.h>
 
 #include <algorithm>
@@ -37,16 +36,81 @@
  * An instantiation of a vector clock where it is assumed that if an index
  * is contained in the clock, all of its po-predecessors are also contained
  * in the clock.
+ *
+ * Clocks of up to inlineSize threads are stored inline, which covers most
+ * programs without any heap allocation. Larger clocks live in a buffer
+ * owned by the view.
  */
 class View : public VectorClock {
 private:
-	typedef llvm::IndexedMap<int> EventView;
-	EventView view_;
+	struct Rep {
+		unsigned int capacity;
+
+		int *data() { return reinterpret_cast<int *>(this + 1); }
+		const int *data() const { return reinterpret_cast<const int *>(this + 1); }
+	};
+
+	/* Number of entries stored inline (fills up the object
+	 * on 64-bit platforms) */
+	static constexpr unsigned int inlineSize = 6;
+
+	/* Returns a fresh representation that has room for CAP entries,
+	 * and holds the first SIZE entries of OLD */
+	static Rep *createRep(unsigned int cap, const int *old, unsigned int size);
+
+	/* Deletes REP (if any) */
+	static void releaseRep(Rep *rep);
+
+	/* Ensures that the storage has at least SIZE entries */
+	void grow(unsigned int size);
+
+	int *data() { return rep_ ? rep_->data() : inline_; }
+	const int *data() const { return rep_ ? rep_->data() : inline_; }
+
+	inline int get(int idx) const {
+		return (idx < (int) size_) ? data()[idx] : 0;
+	}
+
+	void swap(View &v) {
+		std::swap(size_, v.size_);
+		std::swap(rep_, v.rep_);
+		std::swap_ranges(inline_, inline_ + inlineSize, v.inline_);
+	}
+
+	unsigned int size_ = 0;
+	Rep *rep_ = nullptr;
+	int inline_[inlineSize];
 
 public:
 	/* Constructors */
-	View() : VectorClock(VectorClock::VectorClockKind::VC_View),
-		 view_(EventView(0)) {}
+	View() : VectorClock(VectorClock::VectorClockKind::VC_View) {}
+	View(const View &v) : VectorClock(v), size_(v.size_), rep_(nullptr) {
+		if (v.rep_)
+			rep_ = createRep(size_, v.data(), size_);
+		else
+			std::copy(v.inline_, v.inline_ + size_, inline_);
+	}
+	View(View &&v) : VectorClock(v), size_(v.size_), rep_(v.rep_) {
+		if (!rep_)
+			std::copy(v.inline_, v.inline_ + size_, inline_);
+		v.rep_ = nullptr;
+		v.size_ = 0;
+	}
+
+	View &operator=(const View &v) {
+		View tmp(v);
+		swap(tmp);
+		return *this;
+	}
+	View &operator=(View &&v) {
+		swap(v);
+		return *this;
+	}
+
+	~View() { releaseRep(rep_); }
+
+	/* Returns the number of bytes of heap storage in use by all views */
+	static long long getHeapBytesInUse();
 
 	/* Iterators */
 	typedef int *iterator;
@@ -57,13 +121,13 @@ public:
 	const_iterator cend()	{ return &((*this)[0]) + size(); }
 
 	/* Returns the size of this view (i.e., number of threads seen) */
-	unsigned int size() const { return view_.size(); }
+	unsigned int size() const { return size_; }
 
 	/* Returns true if this view is empty */
 	bool empty() const { return size() == 0; }
 
 	/* Returns true if e is contained in the clock */
-	bool contains(const Event e) const { return e.index <= (*this)[e.thread]; }
+	bool contains(const Event e) const { return e.index <= get(e.thread); }
 
 	/* Updates the view based on another vector clock. We can
 	 * only update the current view given another View (and not
@@ -74,21 +138,18 @@ public:
 
 	/* Makes the maximum event seen in e's thread equal to e */
 	View& updateIdx(const Event e) {
-		if ((*this)[e.thread] < e.index)
+		if (get(e.thread) < e.index)
 			(*this)[e.thread] = e.index;
 		return *this;
 	}
 
 	/* Overloaded operators */
 	inline int operator[](int idx) const {
-		if (idx < (int) view_.size())
-			return view_[idx];
-		else
-			return 0;
+		return get(idx);
 	}
 	inline int &operator[](int idx) {
-		view_.grow(idx);
-		return view_[idx];
+		grow(idx + 1);
+		return data()[idx];
 	}
 	inline bool operator<=(const View &v) const {
 		for (auto i = 0u; i < this->size(); i++)
@@ -20,7 +20,9 @@
 
 #include "WBCalculator.hpp"
 #include "GraphIterators.hpp"
+#include "TaskPool.hpp"
 #include "WBIterator.hpp"
+#include <atomic>
 
 bool WBCalculator::isLocOrderedRestricted(SAddr addr, const VectorClock &v) const
 {
@@ -985,75 +987,100 @@ void WBCalculator::initCalc()
 	auto &coRelation = g.getPerLocRelation(ExecutionGraph::RelationId::co);
 
 	coRelation.clear(); /* in case this is called directly (e.g., from PersChecker) */
+	std::vector<std::pair<SAddr, GlobalRelation *> > locs;
 	for (auto it = begin(); it != end(); ++it)
-		coRelation[it->first] = calcWb(it->first);
+		locs.push_back(std::make_pair(it->first, &coRelation[it->first]));
+
+	/* Locations are independent of each other */
+	TaskPool::parallelFor(locs.size(), [&](std::size_t i){
+		*locs[i].second = calcWb(locs[i].first);
+	});
 	return;
 }
 
-Calculator::CalculationResult WBCalculator::doCalc()
+Calculator::CalculationResult
+WBCalculator::extendWb(GlobalRelation &matrix, const GlobalRelation &hbRelation) const
 {
 	auto &g = getGraph();
-	auto &hbRelation = g.getGlobalRelation(ExecutionGraph::RelationId::hb);
-	auto &coRelation = g.getPerLocRelation(ExecutionGraph::RelationId::co);
+	auto &stores = matrix.getElems();
 
-	bool changed = false;
-	for (auto locIt = begin(); locIt != end(); ++locIt) {
-		auto &matrix = coRelation[locIt->first];
-		auto &stores = matrix.getElems();
+	/* If it is empty, nothing to do */
+	if (stores.empty())
+		return CalculationResult(false, true);
 
-		/* If it is empty, nothing to do */
-		if (stores.empty())
-			continue;
+	auto upperLimit = calcRMWLimits(matrix);
+	if (upperLimit.empty()) {
+		for (auto i = 0u; i < stores.size(); i++)
+			matrix.addEdge(i, i);
+		return Calculator::CalculationResult(true, false);
+	}
 
-		auto upperLimit = calcRMWLimits(matrix);
-		if (upperLimit.empty()) {
-			for (auto i = 0u; i < stores.size(); i++)
-				matrix.addEdge(i, i);
-			return Calculator::CalculationResult(true, false);
-		}
+	bool changed = false;
+	auto lowerLimit = upperLimit.begin() + stores.size();
+	for (auto i = 0u; i < stores.size(); i++) {
+		auto *wLab = static_cast<const WriteLabel *>(g.getEventLabel(stores[i]));
+		std::vector<Event> es(wLab->getReadersList());
+		es.push_back(wLab->getPos());
 
-		auto lowerLimit = upperLimit.begin() + stores.size();
-		for (auto i = 0u; i < stores.size(); i++) {
-			auto *wLab = static_cast<const WriteLabel *>(g.getEventLabel(stores[i]));
-			std::vector<Event> es(wLab->getReadersList());
-			es.push_back(wLab->getPos());
-
-			auto upi = upperLimit[i];
-			for (auto j = 0u; j < stores.size(); j++) {
-				if (i == j ||
-				    std::none_of(es.begin(), es.end(), [&](Event e)
-						 { return g.isWriteRfBeforeRel(hbRelation, stores[j], e); }))
-					continue;
-
-				if (!matrix(j, i)) {
-					changed = true;
-					matrix.addEdge(j, i);
-				}
-				if (upi == stores.size() || upi == upperLimit[j])
-					continue;
+		auto upi = upperLimit[i];
+		for (auto j = 0u; j < stores.size(); j++) {
+			if (i == j ||
+			    std::none_of(es.begin(), es.end(), [&](Event e)
+					 { return g.isWriteRfBeforeRel(hbRelation, stores[j], e); }))
+				continue;
 
-				if (!matrix(lowerLimit[j], upi)) {
-					matrix.addEdge(lowerLimit[j], upi);
-					changed = true;
-				}
+			if (!matrix(j, i)) {
+				changed = true;
+				matrix.addEdge(j, i);
 			}
-
-			if (lowerLimit[stores.size()] == stores.size() || upi == stores.size())
+			if (upi == stores.size() || upi == upperLimit[j])
 				continue;
 
-			if (!matrix(lowerLimit[stores.size()], i)) {
-				matrix.addEdge(lowerLimit[stores.size()], i);
+			if (!matrix(lowerLimit[j], upi)) {
+				matrix.addEdge(lowerLimit[j], upi);
 				changed = true;
 			}
 		}
-		matrix.transClosure();
 
-		/* Check for consistency */
-		if (!matrix.isIrreflexive())
-			return Calculator::CalculationResult(changed, false);
+		if (lowerLimit[stores.size()] == stores.size() || upi == stores.size())
+			continue;
 
+		if (!matrix(lowerLimit[stores.size()], i)) {
+			matrix.addEdge(lowerLimit[stores.size()], i);
+			changed = true;
+		}
 	}
-	return CalculationResult(changed, true);
+	matrix.transClosure();
+
+	/* Check for consistency */
+	return CalculationResult(changed, matrix.isIrreflexive());
+}
+
+Calculator::CalculationResult WBCalculator::doCalc()
+{
+	auto &g = getGraph();
+	auto &hbRelation = g.getHbRelation();
+	auto &coRelation = g.getPerLocRelation(ExecutionGraph::RelationId::co);
+
+	std::vector<GlobalRelation *> matrices;
+	for (auto locIt = begin(); locIt != end(); ++locIt)
+		matrices.push_back(&coRelation[locIt->first]);
+
+	/* Each location only reads hb and writes its own matrix */
+	std::vector<CalculationResult> results(matrices.size());
+	std::atomic<bool> inconsistent(false);
+	TaskPool::parallelFor(matrices.size(), [&](std::size_t i){
+		if (inconsistent.load(std::memory_order_relaxed))
+			return;
+		results[i] = extendWb(*matrices[i], hbRelation);
+		if (!results[i].cons)
+			inconsistent.store(true, std::memory_order_relaxed);
+	});
+
+	CalculationResult result;
+	for (auto &r : results)
+		result |= r;
+	return result;
 }
 
 void WBCalculator::removeAfter(const VectorClock &preds)
@@ -168,6 +168,8 @@ public:
 
 	Calculator::CalculationResult doCalc() override;
 
+	bool isIndependent() const override { return true; }
+
 	void removeAfter(const VectorClock &preds) override;
 
 #ifdef ENABLE_GENMC_DEBUG
@@ -198,6 +200,10 @@ private:
 
 	std::vector<unsigned int> calcRMWLimits(const GlobalRelation &wb) const;
 
+	/* Performs one round of the WB calculation on the coherence
+	 * matrix of a single location */
+	CalculationResult extendWb(GlobalRelation &matrix, const GlobalRelation &hbRelation) const;
+
 	View getRfOptHbBeforeStores(SAddr addr, Event e);
 	void expandMaximalAndMarkOverwritten(SAddr addr, View &storeView);
 
@@ -251,7 +257,7 @@ WBCalculator::calcWbRelation(SAddr addr, GlobalRelation &wb,
 			     F prop /* = [](Event e){ return true; } */)
 {
 	auto &gm = getGraph();
-	auto &hbRelation = gm.getGlobalRelation(ExecutionGraph::RelationId::hb);
+	auto &hbRelation = gm.getHbRelation();
 
 	return calcWbRelation(addr, wb, hbRelation, prop);
 }
@@ -33,7 +33,8 @@ void XBCalculator::initCalc()
 	/* Xb should have the same events as prop -- runs after prop inits */
 	auto events = prop.getElems();
 
-	xb = Calculator::GlobalRelation(std::move(events));
+	xb = Calculator::GlobalRelation(std::move(events),
+		g.getRelationBackend(ExecutionGraph::RelationId::xb));
 	g.populatePPoRfEntries(xb);
 	xb.transClosure();
 	return;
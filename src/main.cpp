@@ -23,6 +23,7 @@
 #include "DriverFactory.hpp"
 #include "Error.hpp"
 #include "LLVMModule.hpp"
+#include <llvm/Support/raw_os_ostream.h>
 
 #include <cstdlib>
 #include <chrono>
@@ -96,9 +97,32 @@ void printResults(const std::shared_ptr<const Config> &conf,
 	if (res.exploredMoot) {
 		llvm::outs() << " (" << res.exploredMoot << " mooted)";
 	}
+	if (conf->printMemStats && res.labelCount > 0) {
+		llvm::outs() << "\nAverage memory per event: "
+			     << llvm::format("%.1f", (double) res.labelBytes / res.labelCount)
+			     << " bytes";
+	}
+	if (conf->printChannelStats) {
+		for (auto &kv : res.channelStats)
+			llvm::outs() << "\nChannel " << kv.first << " send-order checks: "
+				     << kv.second.linear << " linear, "
+				     << kv.second.closure << " closure";
+	}
 	llvm::outs() << "\nTotal wall-clock time: "
 		     << llvm::format("%.2f", elapsed.count() * 1e-3)
 		     << "s\n";
+
+	if (conf->printStats)
+		Stats::print(llvm::outs(), res.stats);
+	if (conf->statsFile != "") {
+		std::ofstream fout(conf->statsFile);
+		if (!fout) {
+			WARN("Failed to write statistics to file " + conf->statsFile + "\n");
+			return;
+		}
+		llvm::raw_os_ostream os(fout);
+		Stats::printJSON(os, res.stats);
+	}
 }
 
 int main(int argc, char **argv)
@@ -0,0 +1,32 @@
+void __VERIFIER_ChannelOpen(int ch);
+void __VERIFIER_ChannelSend(int ch, int val);
+void __VERIFIER_ChannelReceive(int ch);
+
+#define CH 1
+
+atomic_int data[N];
+
+void *producer(void *unused)
+{
+	for (int i = 0; i < N; i++) {
+		atomic_store_explicit(&data[i], 42, memory_order_relaxed);
+		__VERIFIER_ChannelSend(CH, i);
+	}
+	return NULL;
+}
+
+void *consumer(void *unused)
+{
+	for (int i = 0; i < N; i++) {
+		__VERIFIER_ChannelReceive(CH);
+		atomic_load_explicit(&data[i], memory_order_relaxed);
+	}
+	return NULL;
+}
+
+void *writer(void *unused)
+{
+	for (int i = 0; i < N; i++)
+		atomic_store_explicit(&data[i], 17, memory_order_relaxed);
+	return NULL;
+}
@@ -0,0 +1,20 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../handoff.c"
+
+int main()
+{
+	pthread_t tp, tc, tw;
+
+	__VERIFIER_ChannelOpen(CH);
+	if (pthread_create(&tp, NULL, producer, NULL))
+		abort();
+	if (pthread_create(&tc, NULL, consumer, NULL))
+		abort();
+	if (pthread_create(&tw, NULL, writer, NULL))
+		abort();
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+void __VERIFIER_ChannelOpen(int ch);
+void __VERIFIER_ChannelSend(int ch, int val);
+void __VERIFIER_ChannelReceive(int ch);
+
+#define CH 1
+
+int idx[N];
+
+void *producer(void *arg)
+{
+	int i = *((int *) arg);
+	__VERIFIER_ChannelSend(CH, i);
+	return NULL;
+}
+
+void *consumer(void *unused)
+{
+	for (int i = 0; i < N; i++)
+		__VERIFIER_ChannelReceive(CH);
+	return NULL;
+}
@@ -0,0 +1,21 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../mpsc.c"
+
+int main()
+{
+	pthread_t tc, tp[N];
+
+	__VERIFIER_ChannelOpen(CH);
+	if (pthread_create(&tc, NULL, consumer, NULL))
+		abort();
+	for (int i = 0; i < N; i++) {
+		idx[i] = i;
+		if (pthread_create(&tp[i], NULL, producer, &idx[i]))
+			abort();
+	}
+
+	return 0;
+}
@@ -0,0 +1,24 @@
+void __VERIFIER_ChannelOpen(int ch);
+void __VERIFIER_ChannelSend(int ch, int val);
+void __VERIFIER_ChannelReceive(int ch);
+
+#define CH 1
+
+void *producer_one(void *unused)
+{
+	__VERIFIER_ChannelSend(CH, 1);
+	return NULL;
+}
+
+void *producer_two(void *unused)
+{
+	__VERIFIER_ChannelSend(CH, 2);
+	return NULL;
+}
+
+void *consumer(void *unused)
+{
+	for (int i = 0; i < N; i++)
+		__VERIFIER_ChannelReceive(CH);
+	return NULL;
+}
@@ -0,0 +1,21 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../recv-revisit.c"
+
+/* The receives are added first and revisited by the sends */
+int main()
+{
+	pthread_t tc, t1, t2;
+
+	__VERIFIER_ChannelOpen(CH);
+	if (pthread_create(&tc, NULL, consumer, NULL))
+		abort();
+	if (pthread_create(&t1, NULL, producer_one, NULL))
+		abort();
+	if (pthread_create(&t2, NULL, producer_two, NULL))
+		abort();
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../recv-revisit.c"
+
+/* The sends are added first and the receives pick among them */
+int main()
+{
+	pthread_t tc, t1, t2;
+
+	__VERIFIER_ChannelOpen(CH);
+	if (pthread_create(&t1, NULL, producer_one, NULL))
+		abort();
+	if (pthread_create(&t2, NULL, producer_two, NULL))
+		abort();
+	if (pthread_create(&tc, NULL, consumer, NULL))
+		abort();
+
+	return 0;
+}
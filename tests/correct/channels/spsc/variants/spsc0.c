@@ -0,0 +1,18 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../spsc.c"
+
+int main()
+{
+	pthread_t tp, tc;
+
+	__VERIFIER_ChannelOpen(CH);
+	if (pthread_create(&tp, NULL, producer, NULL))
+		abort();
+	if (pthread_create(&tc, NULL, consumer, NULL))
+		abort();
+
+	return 0;
+}
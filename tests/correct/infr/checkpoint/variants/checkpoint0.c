@@ -0,0 +1,63 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*
+ * The first two threads run N events before and after a read whose
+ * value decides what they write. The reads are revisited by the writes
+ * of the other threads, both forwards and backwards, so snapshots past
+ * them must be dropped while the ones before them can be reused. The
+ * expected counts are the same with and without -checkpoint-interval.
+ */
+
+atomic_int x;
+atomic_int y;
+atomic_int p[2];
+
+void *thread_one(void *unused)
+{
+	for (int i = 0; i < N; i++)
+		atomic_store_explicit(&p[0], i, memory_order_relaxed);
+	if (atomic_load_explicit(&y, memory_order_relaxed))
+		atomic_store_explicit(&x, 2, memory_order_relaxed);
+	else
+		atomic_store_explicit(&x, 1, memory_order_relaxed);
+	for (int i = 0; i < N; i++)
+		atomic_store_explicit(&p[0], i, memory_order_relaxed);
+	return NULL;
+}
+
+void *thread_two(void *unused)
+{
+	for (int i = 0; i < N; i++)
+		atomic_store_explicit(&p[1], i, memory_order_relaxed);
+	if (atomic_load_explicit(&x, memory_order_relaxed))
+		atomic_store_explicit(&y, 2, memory_order_relaxed);
+	else
+		atomic_store_explicit(&y, 1, memory_order_relaxed);
+	for (int i = 0; i < N; i++)
+		atomic_store_explicit(&p[1], i, memory_order_relaxed);
+	return NULL;
+}
+
+void *thread_three(void *unused)
+{
+	atomic_store_explicit(&x, 3, memory_order_relaxed);
+	atomic_load_explicit(&y, memory_order_relaxed);
+	atomic_store_explicit(&y, 3, memory_order_relaxed);
+	return NULL;
+}
+
+int main()
+{
+	pthread_t t1, t2, t3;
+
+	if (pthread_create(&t1, NULL, thread_one, NULL))
+		abort();
+	if (pthread_create(&t2, NULL, thread_two, NULL))
+		abort();
+	if (pthread_create(&t3, NULL, thread_three, NULL))
+		abort();
+
+	return 0;
+}
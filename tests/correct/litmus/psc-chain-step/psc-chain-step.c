@@ -0,0 +1,27 @@
+atomic_int x;
+atomic_int y;
+atomic_int z;
+
+void *thread_1(void *arg)
+{
+	atomic_store_explicit(&x, 1, memory_order_seq_cst);
+	atomic_load_explicit(&y, memory_order_seq_cst);
+	atomic_store_explicit(&x, 2, memory_order_seq_cst);
+	return NULL;
+}
+
+void *thread_2(void *arg)
+{
+	atomic_store_explicit(&y, 1, memory_order_seq_cst);
+	atomic_load_explicit(&z, memory_order_seq_cst);
+	atomic_store_explicit(&y, 2, memory_order_seq_cst);
+	return NULL;
+}
+
+void *thread_3(void *arg)
+{
+	atomic_store_explicit(&z, 1, memory_order_seq_cst);
+	atomic_load_explicit(&x, memory_order_seq_cst);
+	atomic_store_explicit(&z, 2, memory_order_seq_cst);
+	return NULL;
+}